@@ -0,0 +1,438 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "Cargo.h"
+#include "CargoPlanner.h"
+#include "EventSink.h"
+#include "Exporter.h"
+#include "KeyTraits.h"
+#include "Metrics.h"
+#include "Simulation.h"
+
+// ── LineReader — streams lines out of a file descriptor ──────────────────────
+// Reads 1 MiB chunks with read(2) and hands out string_views into its own
+// buffer (valid until the next call). A trailing '\r' is stripped, and a final
+// line without '\n' is still returned.
+class LineReader {
+private:
+    int fd;
+    std::vector<char> buf;
+    std::size_t begin;
+    std::size_t end;
+    bool eof;
+
+public:
+    explicit LineReader(int fd, std::size_t chunk = 1 << 20)
+        : fd(fd), buf(chunk), begin(0), end(0), eof(false) {}
+
+    bool next(std::string_view& line) {
+        for (;;) {
+            const char* start = buf.data() + begin;
+            const char* nl = static_cast<const char*>(std::memchr(start, '\n', end - begin));
+            if (nl != nullptr || (eof && begin < end)) {
+                const char* stop = nl != nullptr ? nl : buf.data() + end;
+                line  = std::string_view(start, static_cast<std::size_t>(stop - start));
+                begin = nl != nullptr ? static_cast<std::size_t>(nl - buf.data()) + 1 : end;
+                if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                return true;
+            }
+            if (eof) return false;
+
+            if (begin > 0) {                       // keep the partial line, drop the rest
+                std::memmove(buf.data(), start, end - begin);
+                end  -= begin;
+                begin = 0;
+            }
+            if (end == buf.size()) buf.resize(buf.size() * 2);  // one very long line
+            ssize_t r = ::read(fd, buf.data() + end, buf.size() - end);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) eof = true;
+            else        end += static_cast<std::size_t>(r);
+        }
+    }
+};
+
+// ── BatchStats — what a batch run did ────────────────────────────────────────
+struct BatchStats {
+    long long lines       = 0;
+    long long commands    = 0;  // executed operations (a batched load counts per item)
+    long long failed      = 0;  // operations that returned something other than Ok
+    long long parseErrors = 0;
+};
+
+// ── LineResult — outcome of one command line, for front-ends that answer ────
+// each line (see BatchRunner::replyTo()).
+struct LineResult {
+    OpResult    result = OpResult::Ok;
+    const char* error  = nullptr;  // parse error message; result is then unused
+};
+
+// ── CommitsInBatches — containers with deferCommits() / commitPending() ─────
+// The journaling wrappers (Journal.h); BatchRunner commits them once per
+// finish() instead of once per op.
+template <typename C, typename = void>
+struct CommitsInBatches : std::false_type {};
+
+template <typename C>
+struct CommitsInBatches<C, std::void_t<decltype(std::declval<C&>().commitPending())>> : std::true_type {};
+
+// ── BatchRunner — replays a line-oriented command log against fleet + route ──
+// One command per line, fields separated by '|'; blank lines and lines
+// starting with '#' are skipped:
+//
+//   ADD_TRAIN|<id>|<name>|<maxWeight>      REMOVE_TRAIN|<id>
+//   LOAD|<trainId>|<cargo>|<type>|<weight> UNLOAD|<trainId>|<cargo>
+//   REWEIGH|<trainId>|<cargo>|<weight>
+//   ADD_STATION|<name>                     REMOVE_STATION|<name>
+//   ADVANCE | ADVANCE|<k>                  FLEET | TRAIN|<id> | ROUTE
+//   STATS                                  (operation metrics, see Metrics.h)
+//   PLAN|<cargo>|<type>|<weight>           ASSIGN | ASSIGN|ffd | ASSIGN|bfd
+//   RULE|<station>|<dwell>|<travel>|<unload>|<load>
+//   SIMULATE|<until> | SIMULATE|<until>|<threads>
+//   FIND_TYPE|<type> | FIND_NAME|<cargo> | FIND_WEIGHT|<min>|<max>
+//   EXPORT|<cargo|fleet|route>|<csv|jsonl|table>[|<offset>|<limit>]
+//
+// Consecutive LOADs for the same train are gathered and applied with
+// TrainFleet::loadCargoBatch() when they fit (otherwise item by item, so the
+// outcome matches a one-by-one replay); consecutive ADD_STATIONs go through
+// RouteLoop::addStations() when every name is new, likewise. ADVANCE|<k> jumps
+// k stations with RouteLoop::advanceBy(). REWEIGH sets the weight of the
+// earliest-loaded item with that name through its handle. PLAN gathers items
+// without naming a train; ASSIGN spreads them over the fleet with the planner
+// (CargoPlanner.h, first-fit decreasing by default) and prints the placement
+// report. RULE sets a station's rule for every later SIMULATE, which runs
+// Simulation.h over the current fleet and route and prints its report. FIND_*
+// print the matching (train, cargo) pairs from the fleet's cargo index.
+// EXPORT streams rows to stdout through Exporter.h, optionally one page.
+//
+// With replyTo() set, every command line gets exactly one LineResult, in line
+// order: deferred LOADs and ADD_STATIONs are answered when they are applied,
+// which is before any later line is answered. EXPORT then goes to std::cout
+// like the display commands, so a front-end can capture all output there.
+//
+// Journaling containers are switched to deferred commits: finish() waits
+// once for every record the batch appended, so a front-end that answers
+// after finish() (FleetServer) only replies once the batch is durable. If
+// that commit fails, every Ok result still in the reply vector becomes
+// JournalFailed; without replyTo() the failure goes to stderr.
+template <typename Fleet, typename Route>
+class BatchRunner {
+private:
+    using T = typename Fleet::Key;
+    // Lookup keys are passed straight from the line buffer: a string_view for
+    // string keys, so only stored ids and names are ever copied.
+    using Lookup = std::decay_t<typename KeyTraits<T>::View>;
+
+    static constexpr std::size_t kMaxFields  = 6;
+    static constexpr std::size_t kMaxPending = 4096;
+    static constexpr long long   kMaxReported = 20;  // parse errors echoed to stderr
+
+    Fleet& fleet;
+    Route& route;
+    BatchStats stats;
+
+    T pendingTrain;
+    std::vector<Cargo<T>> pendingCargo;
+    std::vector<T> pendingStations;
+    std::unordered_set<Lookup> seenStations;  // scratch for flushStations()
+    std::vector<Cargo<T>> planItems;          // PLAN items awaiting ASSIGN
+    std::vector<std::pair<T, typename Simulation<T>::StationRule>> simRules;  // from RULE
+
+    std::vector<LineResult>* results = nullptr;  // see replyTo()
+    OpResult    lineResult = OpResult::Ok;        // the line being executed
+    const char* lineError  = nullptr;
+    bool        deferred   = false;               // line answered by a later flush
+
+    void count(OpResult r, long long n = 1) {
+        stats.commands += n;
+        if (r != OpResult::Ok) stats.failed += n;
+        if (r != OpResult::Ok && n > 0) lineResult = r;
+    }
+
+    // Deferred lines are counted and answered together when applied.
+    void settle(OpResult r, long long n = 1) {
+        stats.commands += n;
+        if (r != OpResult::Ok) stats.failed += n;
+        if (results != nullptr) results->insert(results->end(), static_cast<std::size_t>(n), LineResult{r, nullptr});
+    }
+
+    void parseError(const char* what) {
+        flushCargo();      // answer earlier lines first
+        flushStations();
+        lineError = what;
+        if (++stats.parseErrors <= kMaxReported && results == nullptr)
+            std::cerr << "[Batch] line " << stats.lines << ": " << what << "\n";
+    }
+
+    template <typename Int>
+    static bool parseInt(std::string_view s, Int& out) {
+        auto res = std::from_chars(s.data(), s.data() + s.size(), out);
+        return res.ec == std::errc() && res.ptr == s.data() + s.size();
+    }
+
+    void flushCargo() {
+        if (pendingCargo.empty()) return;
+        if (pendingCargo.size() == 1) {
+            settle(fleet.loadCargo(pendingTrain, std::move(pendingCargo[0])));
+        } else {
+            long long batchWeight = 0;
+            for (const Cargo<T>& c : pendingCargo) batchWeight += c.weight;
+            if (fleet.getRemainingCapacity(pendingTrain) >= batchWeight) {
+                long long n = static_cast<long long>(pendingCargo.size());
+                settle(fleet.loadCargoBatch(pendingTrain, std::move(pendingCargo)), n);
+            } else {
+                for (Cargo<T>& c : pendingCargo) settle(fleet.loadCargo(pendingTrain, std::move(c)));
+            }
+        }
+        pendingCargo.clear();
+    }
+
+    void flushStations() {
+        if (pendingStations.empty()) return;
+        bool fresh = true;
+        seenStations.clear();
+        for (const T& name : pendingStations) {
+            if (route.hasStation(name) || !seenStations.insert(Lookup(name)).second) {
+                fresh = false;
+                break;
+            }
+        }
+        seenStations.clear();
+        if (fresh) {
+            long long n = static_cast<long long>(pendingStations.size());
+            settle(route.addStations(std::move(pendingStations)), n);
+        } else {
+            for (T& name : pendingStations) settle(route.addStation(std::move(name)));
+        }
+        pendingStations.clear();
+    }
+
+    template <typename Hits>
+    void printHits(const char* what, std::string_view key, const Hits& hits) {
+        syncOutput();
+        std::cout << "[Query] " << what << " " << key << ": " << hits.size() << " items\n";
+        for (const auto& h : hits)
+            std::cout << "  [" << h.trainId() << "] " << h.name() << " | Type: " << h.type()
+                      << " | Weight: " << h.weight() << " tons\n";
+        count(OpResult::Ok);
+    }
+
+    // One Group-mode wait for the whole batch (see the class comment).
+    void commitJournal() {
+        bool ok = true;
+        if constexpr (CommitsInBatches<Fleet>::value) ok = fleet.commitPending();
+        if constexpr (CommitsInBatches<Route>::value) ok = route.commitPending() && ok;
+        if (ok) return;
+        if (results == nullptr) {
+            std::cerr << "[Batch] " << toString(OpResult::JournalFailed)
+                      << ": changes since the last commit are not durable\n";
+            return;
+        }
+        for (LineResult& r : *results) {
+            if (r.error != nullptr || r.result != OpResult::Ok) continue;
+            r.result = OpResult::JournalFailed;
+            stats.failed++;
+        }
+    }
+
+    // Display commands print straight to std::cout; drain buffered events first.
+    // Earlier display output still sitting in std::cout's buffer goes out before
+    // those events, so both streams stay in command order on a shared fd.
+    void syncOutput() {
+        std::cout.flush();
+        if (fleet.getSink() != nullptr) fleet.getSink()->flush();
+        if (route.getSink() != nullptr) route.getSink()->flush();
+    }
+
+    // ── apply — split one command line and run it ───────────────────────────
+    void apply(std::string_view line) {
+        std::string_view f[kMaxFields];
+        std::size_t n = 0;
+        for (;;) {
+            std::size_t bar = line.find('|');
+            if (n == kMaxFields - 1 || bar == std::string_view::npos) {
+                f[n++] = line;
+                break;
+            }
+            f[n++] = line.substr(0, bar);
+            line.remove_prefix(bar + 1);
+        }
+        const std::string_view verb = f[0];
+
+        if (verb != "LOAD")        flushCargo();
+        if (verb != "ADD_STATION") flushStations();
+
+        int weight = 0;
+        if (verb == "LOAD") {
+            if (n != 5 || !parseInt(f[4], weight)) return parseError("expected LOAD|train|cargo|type|weight");
+            if (!pendingCargo.empty() && (pendingTrain != f[1] || pendingCargo.size() == kMaxPending))
+                flushCargo();
+            if (pendingCargo.empty()) pendingTrain = T(f[1]);
+            pendingCargo.emplace_back(T(f[2]), T(f[3]), weight);
+            deferred = true;
+        } else if (verb == "UNLOAD") {
+            if (n != 3) return parseError("expected UNLOAD|train|cargo");
+            count(fleet.unloadCargo(Lookup(f[1]), Lookup(f[2])));
+        } else if (verb == "REWEIGH") {
+            if (n != 4 || !parseInt(f[3], weight)) return parseError("expected REWEIGH|train|cargo|weight");
+            count(fleet.updateWeight(Lookup(f[1]), fleet.findCargo(Lookup(f[1]), Lookup(f[2])), weight));
+        } else if (verb == "ADD_TRAIN") {
+            if (n != 4 || !parseInt(f[3], weight)) return parseError("expected ADD_TRAIN|id|name|maxWeight");
+            count(fleet.addTrain(T(f[1]), T(f[2]), weight));
+        } else if (verb == "REMOVE_TRAIN") {
+            if (n != 2) return parseError("expected REMOVE_TRAIN|id");
+            count(fleet.removeTrain(Lookup(f[1])));
+        } else if (verb == "ADD_STATION") {
+            if (n != 2) return parseError("expected ADD_STATION|name");
+            pendingStations.emplace_back(f[1]);
+            deferred = true;
+            if (pendingStations.size() == kMaxPending) flushStations();
+        } else if (verb == "REMOVE_STATION") {
+            if (n != 2) return parseError("expected REMOVE_STATION|name");
+            count(route.removeStation(Lookup(f[1])));
+        } else if (verb == "ADVANCE") {
+            if (n == 1) {
+                count(route.advanceStation());
+            } else {
+                long long k = 0;
+                if (n != 2 || !parseInt(f[1], k)) return parseError("expected ADVANCE or ADVANCE|k");
+                count(route.advanceBy(k));
+            }
+        } else if (verb == "FLEET") {
+            syncOutput();
+            fleet.displayFleet();
+        } else if (verb == "TRAIN") {
+            if (n != 2) return parseError("expected TRAIN|id");
+            syncOutput();
+            fleet.displayTrain(Lookup(f[1]));
+        } else if (verb == "ROUTE") {
+            syncOutput();
+            route.displayRoute();
+        } else if (verb == "PLAN") {
+            if (n != 4 || !parseInt(f[3], weight)) return parseError("expected PLAN|cargo|type|weight");
+            planItems.emplace_back(T(f[1]), T(f[2]), weight);
+        } else if (verb == "ASSIGN") {
+            PlanStrategy strategy = PlanStrategy::FirstFitDecreasing;
+            if (n == 2 && f[1] == "bfd")      strategy = PlanStrategy::BestFitDecreasing;
+            else if (n != 1 && !(n == 2 && f[1] == "ffd"))
+                return parseError("expected ASSIGN, ASSIGN|ffd or ASSIGN|bfd");
+            OpResult applied = OpResult::Ok;
+            PlacementReport<T> report = assignCargo(fleet, std::move(planItems), strategy, &applied);
+            planItems.clear();
+            count(applied, report.placedItems);
+            count(OpResult::Overweight, static_cast<long long>(report.unplaced.size()));
+            syncOutput();
+            report.print(std::cout);
+        } else if (verb == "RULE") {
+            typename Simulation<T>::StationRule rule;
+            if (n != 6 || !parseInt(f[2], rule.dwell) || !parseInt(f[3], rule.travel)
+                || !parseInt(f[4], rule.unloadTons) || !parseInt(f[5], rule.loadTons))
+                return parseError("expected RULE|station|dwell|travel|unload|load");
+            if (!Simulation<T>::validRule(rule))
+                return parseError("RULE values must be >= 0, and dwell and travel not both 0");
+            if (!route.hasStation(Lookup(f[1]))) return count(OpResult::StationNotFound);
+            simRules.emplace_back(T(f[1]), rule);
+            count(OpResult::Ok);
+        } else if (verb == "SIMULATE") {
+            long long until = 0;
+            unsigned threads = 0;
+            if ((n != 2 && n != 3) || !parseInt(f[1], until) || (n == 3 && !parseInt(f[2], threads)))
+                return parseError("expected SIMULATE|until or SIMULATE|until|threads");
+            Simulation<T> sim(route, fleet);
+            for (const auto& r : simRules) sim.setRule(r.first, r.second);  // gone stations are skipped
+            typename Simulation<T>::RunStats run = sim.run(until, threads);
+            count(OpResult::Ok, run.events);
+            syncOutput();
+            sim.report(std::cout);
+        } else if (verb == "FIND_TYPE") {
+            if (n != 2) return parseError("expected FIND_TYPE|type");
+            printHits("type", f[1], fleet.findCargoByType(Lookup(f[1])));
+        } else if (verb == "FIND_NAME") {
+            if (n != 2) return parseError("expected FIND_NAME|cargo");
+            printHits("name", f[1], fleet.findCargoByName(Lookup(f[1])));
+        } else if (verb == "FIND_WEIGHT") {
+            int minWeight = 0, maxWeight = 0;
+            if (n != 3 || !parseInt(f[1], minWeight) || !parseInt(f[2], maxWeight))
+                return parseError("expected FIND_WEIGHT|min|max");
+            std::string range = std::string(f[1]) + ".." + std::string(f[2]) + " tons";
+            printHits("weight", range, fleet.findCargoByWeight(minWeight, maxWeight));
+        } else if (verb == "EXPORT") {
+            ExportFormat format;
+            ExportFilter<T> filter;
+            if ((n != 3 && n != 5) || !parseExportFormat(f[2], format)
+                || (n == 5 && (!parseInt(f[3], filter.offset) || !parseInt(f[4], filter.limit))))
+                return parseError("expected EXPORT|what|format or EXPORT|what|format|offset|limit");
+            if (f[1] != "cargo" && f[1] != "fleet" && f[1] != "route")
+                return parseError("expected EXPORT of cargo, fleet or route");
+            syncOutput();
+            std::string rows;
+            Exporter<T> exporter = results != nullptr ? Exporter<T>(rows, format)
+                                                      : Exporter<T>(STDOUT_FILENO, format);
+            if      (f[1] == "cargo") exporter.cargo(fleet, filter);
+            else if (f[1] == "fleet") exporter.fleet(fleet, filter);
+            else                      exporter.route(route, filter);
+            std::cout << rows;
+            count(OpResult::Ok);
+        } else if (verb == "STATS") {
+            syncOutput();
+            metrics::report(std::cout);
+        } else {
+            parseError("unknown command");
+        }
+    }
+
+public:
+    BatchRunner(Fleet& fleet, Route& route) : fleet(fleet), route(route) {
+        if constexpr (CommitsInBatches<Fleet>::value) fleet.deferCommits(true);
+        if constexpr (CommitsInBatches<Route>::value) route.deferCommits(true);
+    }
+
+    // ── replyTo — append one LineResult per command line to *out ─────────────
+    // nullptr (the default) turns it off; parse errors then go to stderr.
+    void replyTo(std::vector<LineResult>* out) { results = out; }
+
+    // ── execute — apply one command line ─────────────────────────────────────
+    void execute(std::string_view line) {
+        stats.lines++;
+        if (line.empty() || line[0] == '#') return;
+        lineResult = OpResult::Ok;
+        lineError  = nullptr;
+        deferred   = false;
+        apply(line);
+        if (!deferred && results != nullptr) results->push_back(LineResult{lineResult, lineError});
+    }
+
+    // ── finish — apply anything still gathered and flush sinks ───────────────
+    void finish() {
+        flushCargo();
+        flushStations();
+        commitJournal();
+        syncOutput();
+        std::cout.flush();
+    }
+
+    // ── run — stream every line from fd, then finish() ───────────────────────
+    const BatchStats& run(int fd) {
+        LineReader reader(fd);
+        std::string_view line;
+        while (reader.next(line)) execute(line);
+        finish();
+        return stats;
+    }
+
+    const BatchStats& getStats() const { return stats; }
+};
+
+#endif
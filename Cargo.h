@@ -2,17 +2,23 @@
 #define CARGO_H
 
 #include <string>
+#include <utility>
+#include "FleetPolicy.h"
 
-// One cargo item loaded onto a train
+// One cargo item loaded onto a train. T is a plain key type or a FleetPolicy;
+// name and type are its Name, weight its Weight.
 template <typename T>
 struct Cargo {
-    T    name;       // e.g. "Steel Beams"
-    T    type;       // e.g. "Industrial"
-    int  weight;     // in tons
+    using Name   = NameOf<T>;
+    using Weight = WeightOf<T>;
+
+    Name   name;     // e.g. "Steel Beams"
+    Name   type;     // e.g. "Industrial"
+    Weight weight;   // in tons
 
     Cargo() : name(""), type(""), weight(0) {}
-    Cargo(T name, T type, int weight)
-        : name(name), type(type), weight(weight) {}
+    Cargo(Name name, Name type, Weight weight)
+        : name(std::move(name)), type(std::move(type)), weight(weight) {}
 };
 
 #endif
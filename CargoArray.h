@@ -0,0 +1,384 @@
+#ifndef CARGOARRAY_H
+#define CARGOARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Cargo.h"
+#include "KeyTraits.h"
+#include "EventSink.h"
+#include "Metrics.h"
+#include "NodePool.h"
+#include "WeightKernels.h"
+
+// ── CargoArray — structure-of-arrays manifest ────────────────────────────────
+// Drop-in alternative to CargoList with the same interface, selected at
+// compile time (see DefaultManifest in TrainFleet.h). Instead of one heap node
+// per item it keeps parallel contiguous arrays in storage order:
+//   weights[i]  — tons, scanned by the SIMD kernels in WeightKernels.h
+//   typeIds[i]  — small integer id into typeNames (one entry per distinct type)
+//   slots[i]    — the item's slot, which is what a Handle holds
+// and per-slot arrays that never move an item:
+//   names[s]    — cargo name (a deque, so indexed views of it stay valid)
+//   links[s]    — the owner's opaque per-item pointer (setLink())
+//   indexOf[s]  — storage index of the slot's item
+//   prevSame[s] / nextSame[s] — per-name chain in load order
+//
+// T is a plain key type or a FleetPolicy, as for CargoList; weights[] holds
+// its Weight (the SIMD kernels cover int, wider weights use scalar loops).
+//
+// Removal swap-removes: the last item moves into the hole and its slot's
+// indexOf is patched, so it is O(1) and Handles stay valid, but storage order
+// is not load order. Freed slots are reused.
+//
+// Functions (CargoList interface):
+//   loadCargo() / emplaceCargo() / loadCargoBatch() / unloadCargo()
+//   unload() / updateWeight() / find() / ordinalOf() / owns()
+//   nameOf() / typeOf() / weightOf() / setLink() / linkOf()
+//   displayManifest()
+//   getTotalWeight()
+//   getCount() / forEach() / clear() / releaseNodes() / getPoolStats()
+//   setSink()
+// Vectorized queries:
+//   sumWeights()        — recompute the total with the SIMD reduction
+//   countAbove(x)       — items heavier than x tons
+//   countOfType(type)   — items of one type
+//   weightOfType(type)  — tonnage of one type
+//   forEachAbove(x, fn) — visit items heavier than x tons
+template <typename T, template <typename> class Alloc = NodePool>
+class CargoArray {
+public:
+    using Pool    = NoPool;  // no per-item nodes; kept for interface parity
+    using Name    = NameOf<T>;
+    using Weight  = WeightOf<T>;
+    using KeyView = typename KeyTraits<Name>::View;
+
+    // ── Handle — refers to one loaded item by slot; null when default ────────
+    // Tagged with the issuing array, as CargoList's handles are.
+    class Handle {
+    private:
+        friend class CargoArray;
+        std::uint32_t     slot  = kNoSlot;
+        const CargoArray* owner = nullptr;
+        Handle(std::uint32_t slot, const CargoArray* owner) : slot(slot), owner(owner) {}
+
+    public:
+        Handle() = default;
+        explicit operator bool() const { return slot != kNoSlot; }
+        bool operator==(const Handle& o) const { return slot == o.slot; }
+        bool operator!=(const Handle& o) const { return slot != o.slot; }
+    };
+
+private:
+    static constexpr std::uint32_t kNoSlot = static_cast<std::uint32_t>(-1);
+    using IndexKey = typename KeyTraits<Name>::IndexKey;  // views into names[first slot]
+
+    struct Chain {
+        std::uint32_t first;
+        std::uint32_t last;
+    };
+
+    std::vector<Weight>        weights;
+    std::vector<int>           typeIds;
+    std::vector<std::uint32_t> slots;
+    std::deque<Name>           names;
+    std::vector<void*>         links;
+    std::vector<std::uint32_t> indexOf;
+    std::vector<std::uint32_t> prevSame;
+    std::vector<std::uint32_t> nextSame;
+    std::vector<std::uint32_t> freeSlots;
+    std::unordered_map<IndexKey, Chain> byName;
+    std::vector<Name>   typeNames;            // id -> type
+    std::unordered_map<Name, int> typeIdOf;   // type -> id
+    Weight totalWeight;    // running sum, as in CargoList
+    EventSink<Name>* sink; // nullptr = silent
+
+    void emit(EventKind kind, const Name* subject, const Name* extra = nullptr, long long value = 0) {
+        if (sink != nullptr) sink->emit(Event<Name>{kind, subject, nullptr, extra, value});
+    }
+
+    void emitKey(EventKind kind, KeyView key) {
+        if (sink == nullptr) return;
+        if constexpr (std::is_same<KeyView, const Name&>::value) {
+            emit(kind, &key);
+        } else {
+            const Name owned(key);
+            emit(kind, &owned);
+        }
+    }
+
+    int internType(const Name& type) {
+        auto it = typeIdOf.find(type);
+        if (it != typeIdOf.end()) return it->second;
+        int id = static_cast<int>(typeNames.size());
+        typeNames.push_back(type);
+        typeIdOf.emplace(type, id);
+        return id;
+    }
+
+    // -1 if the type never appeared on this manifest
+    int lookupType(const Name& type) const {
+        auto it = typeIdOf.find(type);
+        return it == typeIdOf.end() ? -1 : it->second;
+    }
+
+    // Same chain bookkeeping as CargoList, with slots for pointers.
+    void indexName(std::uint32_t s) {
+        prevSame[s] = nextSame[s] = kNoSlot;
+        auto res = byName.try_emplace(IndexKey(names[s]), Chain{s, s});
+        if (res.second) return;
+        Chain& chain = res.first->second;
+        prevSame[s] = chain.last;
+        nextSame[chain.last] = s;
+        chain.last = s;
+    }
+
+    void unindexName(std::uint32_t s) {
+        auto it = byName.find(IndexKey(names[s]));
+        Chain& chain = it->second;
+        if (prevSame[s] != kNoSlot) nextSame[prevSame[s]] = nextSame[s];
+        else                        chain.first = nextSame[s];
+        if (nextSame[s] != kNoSlot) prevSame[nextSame[s]] = prevSame[s];
+        else                        chain.last = prevSame[s];
+
+        if (chain.first == kNoSlot) {
+            byName.erase(it);
+        } else if (prevSame[s] == kNoSlot && !std::is_same<IndexKey, Name>::value) {
+            std::uint32_t first = chain.first;
+            auto entry = byName.extract(it);
+            entry.key() = IndexKey(names[first]);
+            byName.insert(std::move(entry));
+        }
+    }
+
+    // Store one item at the back of the dense arrays, in a free or new slot.
+    std::uint32_t append(Cargo<T>&& cargo) {
+        std::uint32_t s;
+        if (!freeSlots.empty()) {
+            s = freeSlots.back();
+            freeSlots.pop_back();
+            names[s] = std::move(cargo.name);
+            links[s] = nullptr;
+        } else {
+            s = static_cast<std::uint32_t>(names.size());
+            names.push_back(std::move(cargo.name));
+            links.push_back(nullptr);
+            indexOf.push_back(0);
+            prevSame.push_back(kNoSlot);
+            nextSame.push_back(kNoSlot);
+        }
+        indexOf[s] = static_cast<std::uint32_t>(weights.size());
+        weights.push_back(cargo.weight);
+        typeIds.push_back(internType(cargo.type));
+        slots.push_back(s);
+        indexName(s);
+        totalWeight += cargo.weight;
+        return s;
+    }
+
+public:
+    explicit CargoArray(Pool* = nullptr) : totalWeight(0), sink(consoleSink<Name>()) {}
+
+    CargoArray(const CargoArray&) = delete;
+    CargoArray& operator=(const CargoArray&) = delete;
+
+    // ── clear — drop every item and release the arrays ───────────────────────
+    void clear() {
+        byName.clear();
+        std::vector<Weight>().swap(weights);
+        std::vector<int>().swap(typeIds);
+        std::vector<std::uint32_t>().swap(slots);
+        std::deque<Name>().swap(names);
+        std::vector<void*>().swap(links);
+        std::vector<std::uint32_t>().swap(indexOf);
+        std::vector<std::uint32_t>().swap(prevSame);
+        std::vector<std::uint32_t>().swap(nextSame);
+        std::vector<std::uint32_t>().swap(freeSlots);
+        std::vector<Name>().swap(typeNames);
+        typeIdOf.clear();
+        totalWeight = 0;
+    }
+
+    void releaseNodes() { clear(); }
+
+    // ── loadCargo — append to the back of each array ─────────────────────────
+    OpResult loadCargo(Cargo<T> cargo, Handle* handle = nullptr) {
+        metrics::Scope m(metrics::Op::ManifestLoad);
+        std::uint32_t s = append(std::move(cargo));
+        if (handle != nullptr) *handle = Handle(s, this);
+        emit(EventKind::CargoLoaded, &names[s], &typeNames[typeIds.back()], weights.back());
+        return OpResult::Ok;
+    }
+
+    // ── emplaceCargo — takes Cargo's constructor arguments ───────────────────
+    // The name is moved into the array; the type is interned.
+    template <typename... Args>
+    OpResult emplaceCargo(Args&&... args) {
+        return loadCargo(Cargo<T>(std::forward<Args>(args)...));
+    }
+
+    // ── loadCargoBatch — reserve once, then append every item ────────────────
+    // The new items' Handles are appended to *handles when given.
+    OpResult loadCargoBatch(std::vector<Cargo<T>> items, std::vector<Handle>* handles = nullptr) {
+        metrics::Scope m(metrics::Op::ManifestLoadBatch);
+        m.visit(items.size());
+        std::size_t first = weights.size();
+        weights.reserve(first + items.size());
+        typeIds.reserve(first + items.size());
+        slots.reserve(first + items.size());
+        for (Cargo<T>& cargo : items) {
+            std::uint32_t s = append(std::move(cargo));
+            if (handles != nullptr) handles->push_back(Handle(s, this));
+        }
+        if (sink != nullptr) {
+            for (std::size_t i = first; i < weights.size(); ++i)
+                emit(EventKind::CargoLoaded, &names[slots[i]], &typeNames[typeIds[i]], weights[i]);
+        }
+        return OpResult::Ok;
+    }
+
+    // ── unloadCargo — remove the earliest-loaded item with this name ─────────
+    OpResult unloadCargo(KeyView name, Cargo<T>* removed = nullptr) {
+        auto it = byName.find(name);
+        if (it == byName.end()) {
+            metrics::Scope m(metrics::Op::ManifestUnload);
+            emitKey(EventKind::CargoNotFound, name);
+            return OpResult::CargoNotFound;
+        }
+        return unload(Handle(it->second.first, this), removed);
+    }
+
+    // ── unload — swap-remove the item a Handle refers to ─────────────────────
+    OpResult unload(Handle handle, Cargo<T>* removed = nullptr) {
+        metrics::Scope m(metrics::Op::ManifestUnload);
+        if (!owns(handle)) return OpResult::CargoNotFound;
+        const std::uint32_t s = handle.slot;
+        const std::size_t i = indexOf[s];
+
+        emit(EventKind::CargoUnloaded, &names[s]);
+        unindexName(s);
+        totalWeight -= weights[i];
+        if (removed != nullptr) {
+            removed->name   = std::move(names[s]);
+            removed->type   = typeNames[typeIds[i]];
+            removed->weight = weights[i];
+        } else {
+            names[s] = Name();
+        }
+        std::size_t last = weights.size() - 1;
+        if (i != last) {
+            weights[i] = weights[last];
+            typeIds[i] = typeIds[last];
+            slots[i]   = slots[last];
+            indexOf[slots[i]] = static_cast<std::uint32_t>(i);
+        }
+        weights.pop_back();
+        typeIds.pop_back();
+        slots.pop_back();
+        freeSlots.push_back(s);
+        return OpResult::Ok;
+    }
+
+    // ── updateWeight — reweigh one item in place ─────────────────────────────
+    // Refused (Overweight) only if the new total does not fit in Weight, as in
+    // CargoList; capacity is the caller's concern.
+    OpResult updateWeight(Handle handle, Weight weight) {
+        if (!owns(handle)) return OpResult::CargoNotFound;
+        Weight& w = weights[indexOf[handle.slot]];
+        Weight newTotal;
+        if (!subWeight<Weight>(totalWeight, w, newTotal) || !addWeight<Weight>(newTotal, weight, newTotal))
+            return OpResult::Overweight;
+        totalWeight = newTotal;
+        w = weight;
+        emit(EventKind::CargoReweighed, &names[handle.slot], nullptr, weight);
+        return OpResult::Ok;
+    }
+
+    // ── find — the nth item (0 = earliest loaded) with this name ─────────────
+    Handle find(KeyView name, int nth = 0) const {
+        auto it = byName.find(name);
+        if (it == byName.end() || nth < 0) return Handle();
+        std::uint32_t s = it->second.first;
+        while (s != kNoSlot && nth-- > 0) s = nextSame[s];
+        return Handle(s, this);
+    }
+
+    // ── ordinalOf — position of an item among those sharing its name ─────────
+    int ordinalOf(Handle handle) const {
+        int nth = 0;
+        if (handle.slot == kNoSlot) return 0;
+        for (std::uint32_t s = prevSame[handle.slot]; s != kNoSlot; s = prevSame[s]) nth++;
+        return nth;
+    }
+
+    bool owns(Handle handle) const { return handle.slot != kNoSlot && handle.owner == this; }
+
+    const Name& nameOf(Handle handle) const { return names[handle.slot]; }
+    const Name& typeOf(Handle handle) const { return typeNames[typeIds[indexOf[handle.slot]]]; }
+    Weight weightOf(Handle handle) const    { return weights[indexOf[handle.slot]]; }
+
+    void  setLink(Handle handle, void* link) { links[handle.slot] = link; }
+    void* linkOf(Handle handle) const        { return links[handle.slot]; }
+
+    // ── displayManifest — walk the arrays in storage order ───────────────────
+    void displayManifest() const {
+        metrics::Scope m(metrics::Op::ManifestDisplay);
+        m.visit(weights.size());
+        if (weights.empty()) {
+            std::cout << "    (no cargo loaded)\n";
+            return;
+        }
+        for (std::size_t i = 0; i < weights.size(); ++i) {
+            std::cout << "    " << i + 1 << ". "
+                      << names[slots[i]]
+                      << " | Type: "   << typeNames[typeIds[i]]
+                      << " | Weight: " << weights[i] << " tons\n";
+        }
+    }
+
+    // ── forEach — storage order, calling fn(name, type, weight) ──────────────
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (std::size_t i = 0; i < weights.size(); ++i)
+            fn(names[slots[i]], typeNames[typeIds[i]], weights[i]);
+    }
+
+    Weight getTotalWeight() const { return totalWeight; }
+    int getCount() const { return static_cast<int>(weights.size()); }
+    PoolStats getPoolStats() const { return PoolStats(); }
+
+    void setSink(EventSink<Name>* s) { sink = s; }
+
+    // ── Vectorized queries ───────────────────────────────────────────────────
+    long long sumWeights() const {
+        return kernels::sumWeights(weights.data(), weights.size());
+    }
+
+    std::size_t countAbove(Weight x) const {
+        return kernels::countAbove(weights.data(), weights.size(), x);
+    }
+
+    std::size_t countOfType(const Name& type) const {
+        int id = lookupType(type);
+        return id < 0 ? 0 : kernels::countEqual(typeIds.data(), typeIds.size(), id);
+    }
+
+    long long weightOfType(const Name& type) const {
+        int id = lookupType(type);
+        if (id < 0) return 0;
+        return kernels::sumWhereEqual(weights.data(), typeIds.data(), weights.size(), id);
+    }
+
+    template <typename Fn>
+    void forEachAbove(Weight x, Fn fn) const {
+        for (std::size_t i = 0; i < weights.size(); ++i)
+            if (weights[i] > x) fn(names[slots[i]], typeNames[typeIds[i]], weights[i]);
+    }
+};
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef CARGOINDEX_H
+#define CARGOINDEX_H
+
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Cargo.h"
+#include "KeyTraits.h"
+#include "NodePool.h"
+
+template <typename T, typename Train, template <typename> class Alloc>
+class CargoIndex;
+
+// ── CargoBucket — every record sharing one type (or one name) ────────────────
+// Owns the key text once; records point back here instead of copying it.
+template <typename T, typename Record>
+struct CargoBucket {
+    T                    key;
+    std::vector<Record*> items;
+
+    explicit CargoBucket(const T& key) : key(key) {}
+};
+
+// ── IndexedCargo — handle to one indexed (train, cargo) pair ─────────────────
+// Returned by CargoIndex queries; valid until that item is unloaded or its
+// train is removed. T is the fleet's key type or FleetPolicy.
+template <typename T, typename Train>
+class IndexedCargo {
+private:
+    template <typename, typename, template <typename> class>
+    friend class CargoIndex;
+    using Name   = NameOf<T>;
+    using Weight = WeightOf<T>;
+    using Bucket = CargoBucket<Name, IndexedCargo>;
+
+    Train*       owner      = nullptr;
+    Weight       tons       = 0;
+    Bucket*      typeBucket = nullptr;
+    Bucket*      nameBucket = nullptr;
+    std::size_t  typePos    = 0;  // slot in typeBucket->items
+    std::size_t  namePos    = 0;  // slot in nameBucket->items
+    typename std::multimap<Weight, IndexedCargo*>::iterator weightPos;
+    IndexedCargo* prevInTrain = nullptr;  // the train's records, newest first
+    IndexedCargo* nextInTrain = nullptr;
+
+public:
+    const Train&    train() const   { return *owner; }
+    const IdOf<T>&  trainId() const { return owner->id; }
+    const Name&     name() const    { return nameBucket->key; }
+    const Name&     type() const    { return typeBucket->key; }
+    Weight          weight() const  { return tons; }
+    Cargo<T>        cargo() const   { return Cargo<T>(name(), type(), tons); }
+};
+
+// ── CargoHits — forward range of records from one query ──────────────────────
+// Wraps the index's own iterators; dereferences to const IndexedCargo&.
+template <typename Record, typename It>
+class CargoHits {
+private:
+    It first, last;
+
+    static const Record& get(Record* const& r) { return *r; }
+    template <typename K>
+    static const Record& get(const std::pair<const K, Record*>& entry) { return *entry.second; }
+
+public:
+    class iterator {
+    private:
+        It it;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Record;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const Record*;
+        using reference         = const Record&;
+
+        explicit iterator(It it) : it(it) {}
+        reference operator*() const  { return get(*it); }
+        pointer   operator->() const { return &get(*it); }
+        iterator& operator++()       { ++it; return *this; }
+        iterator  operator++(int)    { iterator old = *this; ++it; return old; }
+        bool operator==(const iterator& o) const { return it == o.it; }
+        bool operator!=(const iterator& o) const { return it != o.it; }
+    };
+
+    CargoHits(It first, It last) : first(first), last(last) {}
+
+    iterator    begin() const { return iterator(first); }
+    iterator    end() const   { return iterator(last); }
+    bool        empty() const { return first == last; }
+    std::size_t size() const  { return static_cast<std::size_t>(std::distance(first, last)); }
+};
+
+// ── CargoIndex — fleet-wide secondary indexes over every loaded item ─────────
+// One pooled record per cargo item, reachable three ways:
+//   byType   — type -> bucket of records (vector, swap-remove by stored slot)
+//   byName   — name -> bucket of records, i.e. which trains hold that name
+//   byWeight — ordered multimap weight -> record, for range queries
+// Each train also threads its records on an intrusive list (Train::indexed),
+// so a removed train drops its records without a search.
+//
+// Functions:
+//   add(train, name, type, weight)    — index one loaded item, returning its
+//                                       record for the owner to keep
+//   remove(record)                    — drop that item's record
+//   reweigh(record, weight)           — move a record within byWeight
+//   removeTrain(train)                — drop every record of a train
+//   clear()
+// Queries (CargoHits ranges of const Record&):
+//   ofType(type) / named(name)        — O(1) to the bucket, then its size
+//   weighing(min, max)                — O(log n) to the range, inclusive
+//   getCount()
+//
+// The owner keeps each item's record next to the item (TrainFleet stores it
+// in the manifest through setLink()), so nothing is ever searched for.
+// Costs on the owner's hot paths: add is two hash lookups, two vector
+// appends and one multimap insert; remove is two swap-removes and one
+// multimap erase, O(1) plus the erase; reweigh is one multimap erase and
+// insert. Key texts are stored once per distinct type and name.
+template <typename T, typename Train, template <typename> class Alloc = NodePool>
+class CargoIndex {
+public:
+    using Name        = NameOf<T>;
+    using Weight      = WeightOf<T>;
+    using Record      = IndexedCargo<T, Train>;
+    using KeyView     = typename KeyTraits<Name>::View;
+    using BucketHits  = CargoHits<Record, typename std::vector<Record*>::const_iterator>;
+    using WeightHits  = CargoHits<Record, typename std::multimap<Weight, Record*>::const_iterator>;
+
+private:
+    using IndexKey = typename KeyTraits<Name>::IndexKey;  // views into CargoBucket::key for strings
+    using Bucket   = CargoBucket<Name, Record>;
+    using Buckets  = std::unordered_map<IndexKey, std::unique_ptr<Bucket>>;
+
+    Alloc<Record> pool;
+    Buckets byType;
+    Buckets byName;
+    std::multimap<Weight, Record*> byWeight;
+    std::size_t count;
+
+    static Bucket* bucketFor(Buckets& map, const Name& key) {
+        auto it = map.find(IndexKey(key));
+        if (it != map.end()) return it->second.get();
+        std::unique_ptr<Bucket> bucket(new Bucket(key));
+        Bucket* b = bucket.get();
+        map.emplace(IndexKey(b->key), std::move(bucket));
+        return b;
+    }
+
+    static void join(Bucket* b, Record* r, std::size_t Record::*pos) {
+        r->*pos = b->items.size();
+        b->items.push_back(r);
+    }
+
+    static void leave(Buckets& map, Bucket* b, Record* r, std::size_t Record::*pos) {
+        Record* moved = b->items.back();
+        b->items[r->*pos] = moved;
+        moved->*pos = r->*pos;
+        b->items.pop_back();
+        if (b->items.empty()) map.erase(map.find(IndexKey(b->key)));
+    }
+
+    const std::vector<Record*>& itemsOf(const Buckets& map, KeyView key) const {
+        static const std::vector<Record*> none;
+        auto it = map.find(key);
+        return it == map.end() ? none : it->second->items;
+    }
+
+    void unlink(Record* r) {
+        leave(byType, r->typeBucket, r, &Record::typePos);
+        leave(byName, r->nameBucket, r, &Record::namePos);
+        byWeight.erase(r->weightPos);
+        if (r->prevInTrain != nullptr) r->prevInTrain->nextInTrain = r->nextInTrain;
+        else                           r->owner->indexed = r->nextInTrain;
+        if (r->nextInTrain != nullptr) r->nextInTrain->prevInTrain = r->prevInTrain;
+        pool.destroy(r);
+        count--;
+    }
+
+public:
+    CargoIndex() : count(0) {}
+    ~CargoIndex() { clear(); }
+
+    CargoIndex(const CargoIndex&) = delete;
+    CargoIndex& operator=(const CargoIndex&) = delete;
+
+    Record* add(Train* train, const Name& name, const Name& type, Weight weight) {
+        Record* r = pool.create();
+        r->owner = train;
+        r->tons  = weight;
+        r->typeBucket = bucketFor(byType, type);
+        r->nameBucket = bucketFor(byName, name);
+        join(r->typeBucket, r, &Record::typePos);
+        join(r->nameBucket, r, &Record::namePos);
+        r->weightPos = byWeight.emplace(weight, r);
+        r->nextInTrain = train->indexed;
+        if (train->indexed != nullptr) train->indexed->prevInTrain = r;
+        train->indexed = r;
+        count++;
+        return r;
+    }
+
+    void remove(Record* r) {
+        if (r != nullptr) unlink(r);
+    }
+
+    void reweigh(Record* r, Weight weight) {
+        byWeight.erase(r->weightPos);
+        r->tons = weight;
+        r->weightPos = byWeight.emplace(weight, r);
+    }
+
+    void removeTrain(Train* train) {
+        while (train->indexed != nullptr) unlink(train->indexed);
+    }
+
+    // Trains are being torn down too, so their list heads are not reset.
+    void clear() {
+        if (!Alloc<Record>::kBulkRelease)
+            for (auto& entry : byWeight) pool.destroy(entry.second);
+        byType.clear();
+        byName.clear();
+        byWeight.clear();
+        if (Alloc<Record>::kBulkRelease) pool.releaseAll();  // records are trivially destructible
+        count = 0;
+    }
+
+    BucketHits ofType(KeyView type) const {
+        const std::vector<Record*>& items = itemsOf(byType, type);
+        return BucketHits(items.begin(), items.end());
+    }
+
+    BucketHits named(KeyView name) const {
+        const std::vector<Record*>& items = itemsOf(byName, name);
+        return BucketHits(items.begin(), items.end());
+    }
+
+    WeightHits weighing(Weight minWeight, Weight maxWeight) const {
+        if (minWeight > maxWeight) return WeightHits(byWeight.end(), byWeight.end());
+        return WeightHits(byWeight.lower_bound(minWeight), byWeight.upper_bound(maxWeight));
+    }
+
+    std::size_t getCount() const { return count; }
+};
+
+#endif
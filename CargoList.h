@@ -2,84 +2,373 @@
 #define CARGOLIST_H
 
 #include <iostream>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "Cargo.h"
+#include "KeyTraits.h"
+#include "EventSink.h"
+#include "Metrics.h"
+#include "NodePool.h"
 
-// ── Singly linked node for cargo ──────────────────────────────────────────────
+// ── Doubly linked node for cargo ──────────────────────────────────────────────
 template <typename T>
 struct CargoNode {
     Cargo<T>     data;
     CargoNode<T>* next;
+    CargoNode<T>* prev;
+    CargoNode<T>* nextSame;  // next item with the same name (load order)
+    CargoNode<T>* prevSame;
+    void*         link;      // owner's record for this item (see setLink())
 
-    CargoNode(Cargo<T> data) : data(data), next(nullptr) {}
+    CargoNode(Cargo<T> data)
+        : data(std::move(data)), next(nullptr), prev(nullptr), nextSame(nullptr), prevSame(nullptr),
+          link(nullptr) {}
+
+    // Builds the cargo in place from Cargo's constructor arguments.
+    template <typename... Args>
+    CargoNode(std::in_place_t, Args&&... args)
+        : data(std::forward<Args>(args)...), next(nullptr), prev(nullptr),
+          nextSame(nullptr), prevSame(nullptr), link(nullptr) {}
 };
 
-// ── CargoList — singly linked list nested inside each Train ───────────────────
+// ── CargoList — doubly linked list nested inside each Train ───────────────────
 // Represents the manifest (list of cargo items) for one specific train.
 //
+// Every item is also threaded on a per-name chain (load order), reached from
+// a name index, so removal by name or by handle never walks the manifest.
+//
 // Functions:
-//   loadCargo()     — append a cargo item to the back (push back)
-//   unloadCargo()   — remove a cargo item by name (walk and unlink)
+//   loadCargo()     — append a cargo item to the back (push back); optionally
+//                     hands back a Handle to the new item
+//   emplaceCargo()  — same, constructing the item inside its node
+//   loadCargoBatch()— append many items, splicing one pre-linked chain
+//   unloadCargo()   — remove the earliest-loaded item with a name (O(1))
+//   unload()        — remove the item a Handle refers to (O(1))
+//   updateWeight()  — change an item's weight in place (O(1))
+//   find()          — Handle to the nth item with a name (load order)
+//   ordinalOf()     — which same-name item a Handle is (find()'s nth)
+//   owns()          — does a Handle belong to this list
+//   nameOf() / typeOf() / weightOf() — read an item through its Handle
+//   setLink() / linkOf() — one opaque pointer per item for the owner (a
+//                     fleet keeps the item's CargoIndex record there)
 //   displayManifest()— traverse forward and print all cargo
-//   getTotalWeight()— sum all cargo weights via traversal
-template <typename T>
+//   getTotalWeight()— running total, kept current by load/unload (O(1))
+//   forEach()       — visit every cargo item in manifest order
+//   clear()         — free every node (returned to the pool for reuse)
+//   releaseNodes()  — bulk teardown: run destructors only, leave slots to the
+//                     owner's pool.releaseAll()
+//
+// A Handle stays valid until its item is unloaded, whatever else is loaded
+// or removed meanwhile. unload() and updateWeight() refuse a Handle from
+// another list with CargoNotFound.
+//
+// T is a plain key type or a FleetPolicy (FleetPolicy.h): cargo names and
+// types are its Name, weights and the running total its Weight.
+//
+// Nodes come from an Alloc<CargoNode<T>> pool. A fleet passes one shared pool
+// to all its manifests; a standalone list creates its own.
+//
+// Load/unload messages go to an EventSink (console by default, see
+// setSink()); outcomes come back as OpResult. Loads, unloads and display are
+// counted in Metrics.h.
+template <typename T, template <typename> class Alloc = NodePool>
 class CargoList {
+public:
+    using Pool    = Alloc<CargoNode<T>>;
+    using Name    = NameOf<T>;
+    using Weight  = WeightOf<T>;
+    using KeyView = typename KeyTraits<Name>::View;
+
+    // ── Handle — refers to one loaded item; null when default-constructed ────
+    // Tagged with the list that issued it, so a handle passed to the wrong
+    // list is refused (owns()) instead of unlinking a foreign node.
+    class Handle {
+    private:
+        friend class CargoList;
+        CargoNode<T>*    node  = nullptr;
+        const CargoList* owner = nullptr;
+        Handle(CargoNode<T>* node, const CargoList* owner) : node(node), owner(owner) {}
+
+    public:
+        Handle() = default;
+        explicit operator bool() const { return node != nullptr; }
+        bool operator==(const Handle& o) const { return node == o.node; }
+        bool operator!=(const Handle& o) const { return node != o.node; }
+    };
+
 private:
+    using IndexKey = typename KeyTraits<Name>::IndexKey;  // views into the first node's name
+
+    struct Chain {
+        CargoNode<T>* first;
+        CargoNode<T>* last;
+    };
+
     CargoNode<T>* head;
     CargoNode<T>* tail;
     int count;
+    Weight totalWeight;  // running sum of all cargo weights
+    std::unordered_map<IndexKey, Chain> byName;
+    Pool* pool;
+    std::unique_ptr<Pool> ownPool;  // set only when no shared pool was given
+    EventSink<Name>* sink;          // nullptr = silent
+
+    void emit(EventKind kind, const Name* subject, const Name* extra = nullptr, long long value = 0) {
+        if (sink != nullptr) sink->emit(Event<Name>{kind, subject, nullptr, extra, value});
+    }
+
+    // Events carry a const Name*; a key passed as a view is only turned into a Name
+    // when somebody is listening.
+    void emitKey(EventKind kind, KeyView key) {
+        if (sink == nullptr) return;
+        if constexpr (std::is_same<KeyView, const Name&>::value) {
+            emit(kind, &key);
+        } else {
+            const Name owned(key);
+            emit(kind, &owned);
+        }
+    }
+
+    // Append n to its name's chain, creating the chain keyed by n's name.
+    void indexName(CargoNode<T>* n) {
+        auto res = byName.try_emplace(IndexKey(n->data.name), Chain{n, n});
+        if (res.second) return;
+        Chain& chain = res.first->second;
+        n->prevSame = chain.last;
+        chain.last->nextSame = n;
+        chain.last = n;
+    }
+
+    // Take n off its chain. The key views the chain's first node, so losing
+    // the first node re-keys the entry on its successor (no reallocation).
+    void unindexName(CargoNode<T>* n) {
+        auto it = byName.find(IndexKey(n->data.name));
+        Chain& chain = it->second;
+        if (n->prevSame != nullptr) n->prevSame->nextSame = n->nextSame;
+        else                        chain.first = n->nextSame;
+        if (n->nextSame != nullptr) n->nextSame->prevSame = n->prevSame;
+        else                        chain.last = n->prevSame;
+
+        if (chain.first == nullptr) {
+            byName.erase(it);
+        } else if (n->prevSame == nullptr && !std::is_same<IndexKey, Name>::value) {
+            CargoNode<T>* first = chain.first;
+            auto entry = byName.extract(it);
+            entry.key() = IndexKey(first->data.name);
+            byName.insert(std::move(entry));
+        }
+    }
+
+    OpResult link(CargoNode<T>* newNode, Handle* handle) {
+        if (head == nullptr) {
+            head = tail = newNode;
+        } else {
+            newNode->prev = tail;
+            tail->next    = newNode;
+            tail          = newNode;
+        }
+        indexName(newNode);
+        count++;
+        totalWeight += newNode->data.weight;
+        if (handle != nullptr) *handle = Handle(newNode, this);
+        emit(EventKind::CargoLoaded, &newNode->data.name, &newNode->data.type, newNode->data.weight);
+        return OpResult::Ok;
+    }
 
 public:
-    CargoList() : head(nullptr), tail(nullptr), count(0) {}
+    explicit CargoList(Pool* shared = nullptr)
+        : head(nullptr), tail(nullptr), count(0), totalWeight(0), pool(shared),
+          sink(consoleSink<Name>()) {
+        if (pool == nullptr) {
+            ownPool.reset(new Pool());
+            pool = ownPool.get();
+        }
+    }
+
+    CargoList(const CargoList&) = delete;
+    CargoList& operator=(const CargoList&) = delete;
 
     ~CargoList() {
+        if (ownPool && Pool::kBulkRelease) releaseNodes();  // slabs go with ownPool
+        else                               clear();
+    }
+
+    // ── clear — unlink and recycle every node ────────────────────────────────
+    void clear() {
+        byName.clear();
         CargoNode<T>* cur = head;
         while (cur) {
             CargoNode<T>* next = cur->next;
-            delete cur;
+            pool->destroy(cur);
             cur = next;
         }
+        head = tail = nullptr;
+        count = totalWeight = 0;
+    }
+
+    // ── releaseNodes — destructors only; slots stay with the pool ────────────
+    // Skips the walk entirely when the cargo type needs no destructor.
+    void releaseNodes() {
+        byName.clear();
+        if (!std::is_trivially_destructible<CargoNode<T>>::value) {
+            for (CargoNode<T>* cur = head; cur != nullptr;) {
+                CargoNode<T>* next = cur->next;
+                cur->~CargoNode<T>();
+                cur = next;
+            }
+        }
+        head = tail = nullptr;
+        count = totalWeight = 0;
     }
 
     // ── loadCargo — push to back ──────────────────────────────────────────────
-    // Allocates a new CargoNode and links it after tail.
-    void loadCargo(Cargo<T> cargo) {
-        CargoNode<T>* newNode = new CargoNode<T>(cargo);
+    // Moves the item into a node from the pool and links it after tail; the
+    // new item's Handle goes to *handle when given.
+    OpResult loadCargo(Cargo<T> cargo, Handle* handle = nullptr) {
+        metrics::Scope m(metrics::Op::ManifestLoad);
+        return link(pool->create(std::move(cargo)), handle);
+    }
+
+    // ── emplaceCargo — construct the item directly inside its pool node ──────
+    // Takes Cargo's constructor arguments (name, type, weight).
+    template <typename... Args>
+    OpResult emplaceCargo(Args&&... args) {
+        metrics::Scope m(metrics::Op::ManifestLoad);
+        return link(pool->create(std::in_place, std::forward<Args>(args)...), nullptr);
+    }
+
+    // ── loadCargoBatch — link a whole batch, then splice it after tail ───────
+    // Capacity is the caller's concern (TrainFleet checks the batch once).
+    // Items are moved into their nodes; pass an rvalue to avoid a copy. The
+    // new items' Handles are appended to *handles, in batch order, when given.
+    // If building a node throws, the nodes built so far are destroyed and the
+    // list is left as it was.
+    OpResult loadCargoBatch(std::vector<Cargo<T>> items, std::vector<Handle>* handles = nullptr) {
+        if (items.empty()) return OpResult::Ok;
+        metrics::Scope m(metrics::Op::ManifestLoadBatch);
+        m.visit(items.size());
+        CargoNode<T>* first = nullptr;
+        CargoNode<T>* last  = nullptr;
+        Weight batchWeight  = 0;
+        try {
+            for (Cargo<T>& cargo : items) {
+                CargoNode<T>* node = pool->create(std::move(cargo));
+                node->prev = last;
+                if (last == nullptr) first = node;
+                else                 last->next = node;
+                last         = node;
+                batchWeight += node->data.weight;
+            }
+        } catch (...) {
+            while (first != nullptr) {  // not linked in yet: just free the chain
+                CargoNode<T>* next = first->next;
+                pool->destroy(first);
+                first = next;
+            }
+            throw;
+        }
         if (head == nullptr) {
-            head = tail = newNode;
+            head = first;
         } else {
-            tail->next = newNode;
-            tail       = newNode;
+            first->prev = tail;
+            tail->next  = first;
         }
-        count++;
-        std::cout << "  [Loaded]   \"" << cargo.name
-                  << "\" (" << cargo.type << ", " << cargo.weight << " tons)\n";
+        tail = last;
+        count       += static_cast<int>(items.size());
+        totalWeight += batchWeight;
+        for (CargoNode<T>* cur = first; cur != nullptr; cur = cur->next) {
+            indexName(cur);
+            if (handles != nullptr) handles->push_back(Handle(cur, this));
+            emit(EventKind::CargoLoaded, &cur->data.name, &cur->data.type, cur->data.weight);
+        }
+        return OpResult::Ok;
     }
 
-    // ── unloadCargo — remove by name ──────────────────────────────────────────
-    // Uses a prev pointer to unlink the matching node from the singly linked list.
-    void unloadCargo(T name) {
-        CargoNode<T>* cur  = head;
-        CargoNode<T>* prev = nullptr;
-
-        while (cur != nullptr) {
-            if (cur->data.name == name) {
-                if (prev == nullptr) head = cur->next;  // removing head
-                else                 prev->next = cur->next;
-                if (cur->next == nullptr) tail = prev;  // removing tail
-
-                std::cout << "  [Unloaded] \"" << name << "\"\n";
-                delete cur;
-                count--;
-                return;
-            }
-            prev = cur;
-            cur  = cur->next;
+    // ── unloadCargo — remove the earliest-loaded item with this name ─────────
+    // The name index gives the node directly. Returns CargoNotFound if no item
+    // matched; the removed item is moved into *removed when given, so owners
+    // can keep their own aggregates in sync.
+    OpResult unloadCargo(KeyView name, Cargo<T>* removed = nullptr) {
+        auto it = byName.find(name);
+        if (it == byName.end()) {
+            metrics::Scope m(metrics::Op::ManifestUnload);
+            emitKey(EventKind::CargoNotFound, name);
+            return OpResult::CargoNotFound;
         }
-        std::cout << "  [Error] Cargo \"" << name << "\" not found.\n";
+        return unload(Handle(it->second.first, this), removed);
     }
 
+    // ── unload — remove the item a Handle refers to ──────────────────────────
+    // prev/next and the name chain are relinked in place; nothing is walked.
+    OpResult unload(Handle handle, Cargo<T>* removed = nullptr) {
+        metrics::Scope m(metrics::Op::ManifestUnload);
+        if (!owns(handle)) return OpResult::CargoNotFound;
+        CargoNode<T>* cur = handle.node;
+
+        unindexName(cur);
+        if (cur->prev != nullptr) cur->prev->next = cur->next;
+        else                      head = cur->next;     // removing head
+        if (cur->next != nullptr) cur->next->prev = cur->prev;
+        else                      tail = cur->prev;     // removing tail
+
+        emit(EventKind::CargoUnloaded, &cur->data.name);
+        count--;
+        totalWeight -= cur->data.weight;
+        if (removed != nullptr) *removed = std::move(cur->data);
+        pool->destroy(cur);
+        return OpResult::Ok;
+    }
+
+    // ── updateWeight — reweigh one item in place ─────────────────────────────
+    // Capacity is the caller's concern, as with loadCargoBatch(); only a new
+    // total that does not fit in Weight is refused (Overweight).
+    OpResult updateWeight(Handle handle, Weight weight) {
+        if (!owns(handle)) return OpResult::CargoNotFound;
+        CargoNode<T>* cur = handle.node;
+        Weight newTotal;
+        if (!subWeight<Weight>(totalWeight, cur->data.weight, newTotal) ||
+            !addWeight<Weight>(newTotal, weight, newTotal))
+            return OpResult::Overweight;
+        totalWeight = newTotal;
+        cur->data.weight = weight;
+        emit(EventKind::CargoReweighed, &cur->data.name, nullptr, weight);
+        return OpResult::Ok;
+    }
+
+    // ── find — the nth item (0 = earliest loaded) with this name ─────────────
+    Handle find(KeyView name, int nth = 0) const {
+        auto it = byName.find(name);
+        if (it == byName.end() || nth < 0) return Handle();
+        CargoNode<T>* cur = it->second.first;
+        while (cur != nullptr && nth-- > 0) cur = cur->nextSame;
+        return Handle(cur, this);
+    }
+
+    // ── ordinalOf — position of an item among those sharing its name ─────────
+    int ordinalOf(Handle handle) const {
+        int nth = 0;
+        for (CargoNode<T>* cur = handle.node; cur != nullptr && cur->prevSame != nullptr; cur = cur->prevSame)
+            nth++;
+        return nth;
+    }
+
+    // ── owns — was this non-null handle issued by this list ──────────────────
+    bool owns(Handle handle) const { return handle.node != nullptr && handle.owner == this; }
+
+    const Name& nameOf(Handle handle) const { return handle.node->data.name; }
+    const Name& typeOf(Handle handle) const { return handle.node->data.type; }
+    Weight weightOf(Handle handle) const    { return handle.node->data.weight; }
+
+    void  setLink(Handle handle, void* link) { handle.node->link = link; }
+    void* linkOf(Handle handle) const        { return handle.node->link; }
+
     // ── displayManifest — forward traversal ───────────────────────────────────
     void displayManifest() const {
+        metrics::Scope m(metrics::Op::ManifestDisplay);
+        m.visit(count);
         if (head == nullptr) {
             std::cout << "    (no cargo loaded)\n";
             return;
@@ -95,18 +384,18 @@ public:
         }
     }
 
-    // ── getTotalWeight — accumulate via traversal ─────────────────────────────
-    int getTotalWeight() const {
-        int total = 0;
-        CargoNode<T>* cur = head;
-        while (cur != nullptr) {
-            total += cur->data.weight;
-            cur = cur->next;
-        }
-        return total;
+    // ── forEach — forward traversal calling fn(name, type, weight) ────────────
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        for (CargoNode<T>* cur = head; cur != nullptr; cur = cur->next)
+            fn(cur->data.name, cur->data.type, cur->data.weight);
     }
 
+    Weight getTotalWeight() const { return totalWeight; }
     int getCount() const { return count; }
+    PoolStats getPoolStats() const { return pool->stats(); }
+
+    void setSink(EventSink<Name>* s) { sink = s; }
 };
 
 #endif
@@ -0,0 +1,224 @@
+#ifndef CARGOPLANNER_H
+#define CARGOPLANNER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "Cargo.h"
+#include "EventSink.h"
+#include "Metrics.h"
+
+// ── Cargo planner — assign a batch of items across the whole fleet ───────────
+// loadCargo() places an item on the train the caller names. planCargo() takes
+// a batch and picks the trains itself, never exceeding any train's maxWeight:
+//
+//   FirstFitDecreasing — heaviest item first, onto the earliest train (fleet
+//                        order) with room; a max segment tree over remaining
+//                        capacity finds that train in O(log trains).
+//   BestFitDecreasing  — heaviest item first, onto the train that would have
+//                        the least room left; an ordered multimap keyed by
+//                        remaining capacity finds it in O(log trains).
+//
+// Planning reads the fleet and changes nothing; the PlacementReport says
+// where every item goes. applyPlan() then loads each train's share with one
+// loadCargoBatch(), so a fleet wrapper (JournaledFleet) records one op per
+// train. assignCargo() does both.
+//
+// Functions:
+//   planCargo(fleet, items, strategy)   — PlacementReport, fleet untouched
+//   applyPlan(fleet, items, report)     — load the planned items
+//   assignCargo(fleet, items, strategy) — plan + apply
+//
+// The fleet needs forEachTrain() and loadCargoBatch() (TrainFleet,
+// ConcurrentFleet, JournaledFleet). Cost is O(m log m) to sort m items plus
+// O(m log n) to place them on n trains.
+enum class PlanStrategy { FirstFitDecreasing, BestFitDecreasing };
+
+inline const char* toString(PlanStrategy s) {
+    return s == PlanStrategy::FirstFitDecreasing ? "first-fit decreasing" : "best-fit decreasing";
+}
+
+// ── PlacementReport — where each item of a plan goes ─────────────────────────
+// Trains are numbered in fleet order; trainOf[i] is the train of items[i], or
+// kUnplaced if no train had room for it.
+template <typename T>
+struct PlacementReport {
+    static constexpr int kUnplaced = -1;
+
+    struct TrainPlan {
+        T         id;
+        int       maxWeight = 0;
+        long long freeBefore = 0;  // remaining capacity when planned
+        long long planned    = 0;  // tons assigned by the plan
+        int       items      = 0;  // items assigned by the plan
+    };
+
+    PlanStrategy           strategy = PlanStrategy::FirstFitDecreasing;
+    std::vector<TrainPlan> trains;
+    std::vector<int>       trainOf;   // per input item
+    std::vector<std::size_t> unplaced;  // input indices, heaviest first
+    long long placedItems    = 0;
+    long long placedWeight   = 0;
+    long long unplacedWeight = 0;
+
+    // ── print — summary line, then one line per train that receives cargo ───
+    void print(std::ostream& os) const {
+        char line[160];
+        std::snprintf(line, sizeof line,
+                      "[Planner] %s: %lld/%zu items placed (%lld tons), %zu unplaced (%lld tons)\n",
+                      toString(strategy), placedItems, trainOf.size(), placedWeight,
+                      unplaced.size(), unplacedWeight);
+        os << line;
+        for (const TrainPlan& t : trains) {
+            if (t.items == 0) continue;
+            os << "  [" << t.id << "] +" << t.items << " items, +" << t.planned << " tons -> "
+               << (t.maxWeight - t.freeBefore + t.planned) << "/" << t.maxWeight << " tons\n";
+        }
+    }
+};
+
+// ── CapacityTree — max segment tree over remaining capacity ──────────────────
+// firstFit(w) descends toward the leftmost leaf holding at least w.
+class CapacityTree {
+private:
+    static constexpr long long kNone = std::numeric_limits<long long>::min();
+
+    std::size_t leaves;
+    std::vector<long long> tree;  // tree[1] is the root; leaves start at `leaves`
+
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    explicit CapacityTree(const std::vector<long long>& capacity) : leaves(1) {
+        while (leaves < capacity.size()) leaves *= 2;
+        tree.assign(2 * leaves, kNone);
+        std::copy(capacity.begin(), capacity.end(), tree.begin() + leaves);
+        for (std::size_t i = leaves - 1; i > 0; --i) tree[i] = std::max(tree[2 * i], tree[2 * i + 1]);
+    }
+
+    std::size_t firstFit(long long w) const {
+        if (tree[1] < w) return npos;
+        std::size_t i = 1;
+        while (i < leaves) i = tree[2 * i] >= w ? 2 * i : 2 * i + 1;
+        return i - leaves;
+    }
+
+    void take(std::size_t slot, long long w) {
+        std::size_t i = slot + leaves;
+        tree[i] -= w;
+        for (i /= 2; i > 0; i /= 2) tree[i] = std::max(tree[2 * i], tree[2 * i + 1]);
+    }
+};
+
+// ── planCargo — choose a train for every item, heaviest first ────────────────
+template <typename Fleet, typename T>
+PlacementReport<T> planCargo(const Fleet& fleet, const std::vector<Cargo<T>>& items,
+                             PlanStrategy strategy = PlanStrategy::FirstFitDecreasing) {
+    using Report = PlacementReport<T>;
+    metrics::Scope m(metrics::Op::FleetPlanCargo);
+    m.visit(items.size());
+
+    Report report;
+    report.strategy = strategy;
+    report.trainOf.assign(items.size(), Report::kUnplaced);
+
+    std::vector<long long> capacity;
+    fleet.forEachTrain([&](const T& id, const T&, int maxWeight, const auto& manifest) {
+        typename Report::TrainPlan t;
+        t.id         = id;
+        t.maxWeight  = maxWeight;
+        t.freeBefore = static_cast<long long>(maxWeight) - manifest.getTotalWeight();
+        capacity.push_back(t.freeBefore);
+        report.trains.push_back(std::move(t));
+    });
+
+    // Heaviest first; ties keep input order so plans are reproducible.
+    std::vector<std::size_t> order(items.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return items[a].weight > items[b].weight;
+    });
+
+    auto place = [&](std::size_t item, std::size_t train) {
+        report.trainOf[item] = static_cast<int>(train);
+        report.trains[train].planned += items[item].weight;
+        report.trains[train].items++;
+        report.placedItems++;
+        report.placedWeight += items[item].weight;
+    };
+    auto reject = [&](std::size_t item) {
+        report.unplaced.push_back(item);
+        report.unplacedWeight += items[item].weight;
+    };
+
+    if (strategy == PlanStrategy::FirstFitDecreasing) {
+        CapacityTree tree(capacity);
+        for (std::size_t item : order) {
+            std::size_t train = tree.firstFit(items[item].weight);
+            if (train == CapacityTree::npos) {
+                reject(item);
+                continue;
+            }
+            tree.take(train, items[item].weight);
+            place(item, train);
+        }
+    } else {
+        std::multimap<long long, std::size_t> byRoom;  // remaining capacity -> train
+        for (std::size_t i = 0; i < capacity.size(); ++i) byRoom.emplace(capacity[i], i);
+        for (std::size_t item : order) {
+            auto it = byRoom.lower_bound(items[item].weight);
+            if (it == byRoom.end()) {
+                reject(item);
+                continue;
+            }
+            std::size_t train = it->second;
+            long long left = it->first - items[item].weight;
+            // Re-key the map node in place rather than erase + allocate.
+            auto node = byRoom.extract(it);
+            node.key() = left;
+            byRoom.insert(std::move(node));
+            place(item, train);
+        }
+    }
+    return report;
+}
+
+// ── applyPlan — load each train's share with one loadCargoBatch() ────────────
+// items must be the vector the report was planned from; they are moved into
+// the manifests, unplaced ones are left alone. Returns Ok, or the first
+// failure if the fleet changed since planning (other trains still load).
+template <typename Fleet, typename T>
+OpResult applyPlan(Fleet& fleet, std::vector<Cargo<T>>& items, const PlacementReport<T>& report) {
+    std::vector<std::vector<Cargo<T>>> perTrain(report.trains.size());
+    for (std::size_t t = 0; t < report.trains.size(); ++t) perTrain[t].reserve(report.trains[t].items);
+    for (std::size_t i = 0; i < items.size() && i < report.trainOf.size(); ++i) {
+        int t = report.trainOf[i];
+        if (t != PlacementReport<T>::kUnplaced) perTrain[t].push_back(std::move(items[i]));
+    }
+
+    OpResult result = OpResult::Ok;
+    for (std::size_t t = 0; t < perTrain.size(); ++t) {
+        if (perTrain[t].empty()) continue;
+        OpResult r = fleet.loadCargoBatch(report.trains[t].id, std::move(perTrain[t]));
+        if (r != OpResult::Ok && result == OpResult::Ok) result = r;
+    }
+    return result;
+}
+
+// ── assignCargo — plan, then apply ───────────────────────────────────────────
+template <typename Fleet, typename T>
+PlacementReport<T> assignCargo(Fleet& fleet, std::vector<Cargo<T>> items,
+                               PlanStrategy strategy = PlanStrategy::FirstFitDecreasing,
+                               OpResult* applied = nullptr) {
+    PlacementReport<T> report = planCargo(fleet, items, strategy);
+    OpResult r = applyPlan(fleet, items, report);
+    if (applied != nullptr) *applied = r;
+    return report;
+}
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef CONCURRENTFLEET_H
+#define CONCURRENTFLEET_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "KeyTraits.h"
+#include "PersistentManifest.h"
+#include "TrainFleet.h"
+
+// ── ConcurrentFleet — thread-safe fleet with per-train locking ───────────────
+// Same operations as TrainFleet, safe to call from many threads at once.
+//
+//   index  — the ID -> train map is split into shards (a power of two), each
+//            behind its own shared_mutex; lookups take a shared lock on one
+//            shard only, add/remove take that shard exclusively.
+//   trains — every train has its own mutex. loadCargo() checks capacity and
+//            inserts under that one lock, so two loaders can never both pass
+//            the check and overfill a train. Work on different trains never
+//            contends past the shard lookup.
+//   reads  — manifests are PersistentManifests: each write publishes a new
+//            immutable version, and displays, forEachTrain() and snapshot()
+//            read versions without taking any train lock. A long report
+//            never stalls a loader, and each train it shows is one
+//            point-in-time state (a batch is all there or not at all).
+//   life   — trains are held by shared_ptr. A lookup copies the pointer and
+//            drops the shard lock before locking the train, so removeTrain()
+//            can run while loads are in flight: it unlinks the train, then
+//            marks it removed under the train lock; a loader that loses the
+//            race sees the mark and reports TrainNotFound. Memory goes away
+//            with the last reference.
+//
+// The fleet is silent — it has no sink; every outcome comes back as an
+// OpResult. Capacity checks sum in long long through addWeight() (as
+// TrainFleet does), so a load whose total would overflow is Overweight.
+//
+// Functions:
+//   addTrain() / removeTrain()
+//   loadCargo() / loadCargoBatch() / unloadCargo()
+//   snapshot()                      — FleetView: every train's current version
+//   displayFleet() / displayTrain() — print from versions, no train locks
+//   forEachTrain()                  — fn(id, name, maxWeight, ManifestVersion)
+// Queries (fleet-wide counters are atomics, exact once writers are quiescent):
+//   getSize() / getTotalWeight() / getTotalCapacity() / getCargoCount()
+//   getRemainingCapacity(id)        — free tons on one train (-1 if not found)
+template <typename T>
+class ConcurrentFleet {
+public:
+    using Key      = T;
+    using KeyView  = typename KeyTraits<T>::View;
+    using Manifest = ManifestVersion<T>;
+
+private:
+    using IndexKey = typename KeyTraits<T>::IndexKey;  // views into Train::id for strings
+
+    struct Train {
+        T                     id;
+        T                     name;
+        int                   maxWeight;
+        std::uint64_t         order;    // insertion sequence, for display order
+        std::mutex            m;        // serialises writers to cargo
+        PersistentManifest<T> cargo;
+        std::atomic<bool>     removed;  // set under m; read lock-free
+
+        Train(T id, T name, int maxWeight, std::uint64_t order)
+            : id(std::move(id)), name(std::move(name)), maxWeight(maxWeight), order(order),
+              removed(false) {}
+    };
+    using TrainPtr = std::shared_ptr<Train>;
+
+public:
+    // ── TrainView / FleetView — what snapshot() returns ──────────────────────
+    // Holds the train itself (ID, name and capacity never change) and the
+    // manifest version captured for it.
+    class TrainView {
+    private:
+        friend class ConcurrentFleet;
+        std::shared_ptr<const Train> train;
+        std::shared_ptr<const Manifest> cargo;
+
+    public:
+        const T&        id() const        { return train->id; }
+        const T&        name() const      { return train->name; }
+        int             maxWeight() const { return train->maxWeight; }
+        const Manifest& manifest() const  { return *cargo; }
+    };
+
+    // Totals are summed from the captured versions, so they always agree
+    // with the trains listed.
+    struct FleetView {
+        std::vector<TrainView> trains;  // insertion order
+        long long totalWeight   = 0;
+        long long totalCapacity = 0;
+        long long cargoCount    = 0;
+    };
+
+private:
+    struct alignas(64) Shard {  // one cache line per shard header
+        mutable std::shared_mutex m;
+        std::unordered_map<IndexKey, TrainPtr> trains;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    std::size_t shardMask;
+
+    std::atomic<int>           size;
+    std::atomic<long long>     totalWeight;
+    std::atomic<long long>     totalCapacity;
+    std::atomic<long long>     cargoCount;
+    std::atomic<std::uint64_t> nextOrder;
+
+    Shard& shardFor(KeyView id) const { return shards[std::hash<IndexKey>()(id) & shardMask]; }
+
+    TrainPtr findTrain(KeyView id) const {
+        Shard& s = shardFor(id);
+        std::shared_lock<std::shared_mutex> lock(s.m);
+        auto it = s.trains.find(id);
+        return it == s.trains.end() ? nullptr : it->second;
+    }
+
+    // Every live train, sorted by insertion order (shards are visited one at a time).
+    std::vector<TrainPtr> orderedTrains() const {
+        std::vector<TrainPtr> out;
+        for (std::size_t i = 0; i <= shardMask; ++i) {
+            std::shared_lock<std::shared_mutex> lock(shards[i].m);
+            for (const auto& entry : shards[i].trains) out.push_back(entry.second);
+        }
+        std::sort(out.begin(), out.end(),
+                  [](const TrainPtr& a, const TrainPtr& b) { return a->order < b->order; });
+        return out;
+    }
+
+public:
+    // shardCount is rounded up to a power of two.
+    explicit ConcurrentFleet(std::size_t shardCount = 64)
+        : size(0), totalWeight(0), totalCapacity(0), cargoCount(0), nextOrder(0) {
+        std::size_t n = 1;
+        while (n < shardCount) n <<= 1;
+        shards.reset(new Shard[n]);
+        shardMask = n - 1;
+    }
+
+    ConcurrentFleet(const ConcurrentFleet&) = delete;
+    ConcurrentFleet& operator=(const ConcurrentFleet&) = delete;
+
+    // ── addTrain — insert into the ID's shard; IDs must be unique ────────────
+    OpResult addTrain(T id, T name, int maxWeight) {
+        Shard& s = shardFor(id);
+        std::unique_lock<std::shared_mutex> lock(s.m);
+        if (s.trains.count(id)) return OpResult::DuplicateId;
+        TrainPtr train = std::make_shared<Train>(std::move(id), std::move(name), maxWeight, nextOrder++);
+        IndexKey key(train->id);
+        s.trains.emplace(key, std::move(train));
+        size++;
+        totalCapacity += maxWeight;
+        return OpResult::Ok;
+    }
+
+    // ── removeTrain — unlink from the shard, then retire under the train lock
+    OpResult removeTrain(KeyView id) {
+        TrainPtr train;
+        {
+            Shard& s = shardFor(id);
+            std::unique_lock<std::shared_mutex> lock(s.m);
+            auto it = s.trains.find(id);
+            if (it == s.trains.end()) return OpResult::TrainNotFound;
+            train = std::move(it->second);
+            s.trains.erase(it);
+        }
+        std::lock_guard<std::mutex> lock(train->m);
+        train->removed = true;
+        size--;
+        totalCapacity -= train->maxWeight;
+        totalWeight   -= train->cargo.getTotalWeight();
+        cargoCount    -= train->cargo.getCount();
+        train->cargo.clear();
+        return OpResult::Ok;
+    }
+
+    // ── loadCargo — capacity check and insert under one train lock ───────────
+    OpResult loadCargo(KeyView trainId, Cargo<T> cargo) {
+        TrainPtr train = findTrain(trainId);
+        if (train == nullptr) return OpResult::TrainNotFound;
+        std::lock_guard<std::mutex> lock(train->m);
+        if (train->removed) return OpResult::TrainNotFound;
+        long long newTotal;
+        if (!addWeight<long long>(train->cargo.getTotalWeight(), cargo.weight, newTotal) ||
+            newTotal > train->maxWeight)
+            return OpResult::Overweight;
+        int weight = cargo.weight;
+        train->cargo.loadCargo(std::move(cargo));
+        totalWeight += weight;
+        cargoCount++;
+        return OpResult::Ok;
+    }
+
+    // ── loadCargoBatch — all-or-nothing, one lock for the whole batch ────────
+    OpResult loadCargoBatch(KeyView trainId, std::vector<Cargo<T>> items) {
+        long long batchWeight = 0;
+        bool fits = true;
+        for (const Cargo<T>& c : items) fits = addWeight<long long>(batchWeight, c.weight, batchWeight) && fits;
+
+        TrainPtr train = findTrain(trainId);
+        if (train == nullptr) return OpResult::TrainNotFound;
+        std::lock_guard<std::mutex> lock(train->m);
+        if (train->removed) return OpResult::TrainNotFound;
+        long long newTotal;
+        if (!fits || !addWeight<long long>(train->cargo.getTotalWeight(), batchWeight, newTotal) ||
+            newTotal > train->maxWeight)
+            return OpResult::Overweight;
+        const long long n = static_cast<long long>(items.size());
+        train->cargo.loadCargoBatch(std::move(items));
+        totalWeight += batchWeight;
+        cargoCount  += n;
+        return OpResult::Ok;
+    }
+
+    // ── unloadCargo — remove by name under the train lock ────────────────────
+    OpResult unloadCargo(KeyView trainId, KeyView cargoName) {
+        TrainPtr train = findTrain(trainId);
+        if (train == nullptr) return OpResult::TrainNotFound;
+        std::lock_guard<std::mutex> lock(train->m);
+        if (train->removed) return OpResult::TrainNotFound;
+        Cargo<T> removed;
+        OpResult r = train->cargo.unloadCargo(cargoName, &removed);
+        if (r == OpResult::Ok) {
+            totalWeight -= removed.weight;
+            cargoCount--;
+        }
+        return r;
+    }
+
+    // ── snapshot — every live train with its current manifest version ───────
+    // One atomic load per train and no train locks; writers carry on while
+    // the view is printed or exported, and never change what it shows.
+    FleetView snapshot() const {
+        FleetView view;
+        for (TrainPtr& train : orderedTrains()) {
+            if (train->removed) continue;
+            TrainView t;
+            t.cargo = train->cargo.snapshot();
+            view.totalWeight   += t.cargo->getTotalWeight();
+            view.totalCapacity += train->maxWeight;
+            view.cargoCount    += t.cargo->getCount();
+            t.train = std::move(train);
+            view.trains.push_back(std::move(t));
+        }
+        return view;
+    }
+
+    // ── displayTrain — show one train + its full manifest ────────────────────
+    void displayTrain(KeyView id) const {
+        TrainPtr train = findTrain(id);
+        if (train == nullptr) {
+            std::cout << "[Fleet] Train \"" << id << "\" not found.\n";
+            return;
+        }
+        std::shared_ptr<const Manifest> cargo = train->cargo.snapshot();
+        std::cout << "\n  Train : [" << train->id << "] " << train->name << "\n"
+                  << "  Weight: " << cargo->getTotalWeight()
+                  << "/" << train->maxWeight << " tons"
+                  << " | Cargo items: " << cargo->getCount() << "\n"
+                  << "  Manifest:\n";
+        cargo->displayManifest();
+    }
+
+    // ── displayFleet — print one snapshot() in insertion order ───────────────
+    void displayFleet() const {
+        FleetView view = snapshot();
+        if (view.trains.empty()) {
+            std::cout << "[Fleet] No trains in fleet.\n";
+            return;
+        }
+        std::cout << "\n======= TRAIN FLEET (" << view.trains.size() << " trains) =======\n";
+        int i = 1;
+        for (const TrainView& train : view.trains) {
+            std::cout << "\n  #" << i++ << " [" << train.id() << "] " << train.name()
+                      << " | " << train.manifest().getTotalWeight()
+                      << "/" << train.maxWeight() << " tons"
+                      << " | " << train.manifest().getCount() << " cargo items\n"
+                      << "  Manifest:\n";
+            train.manifest().displayManifest();
+        }
+        std::cout << "\n  Fleet load: " << view.totalWeight << "/" << view.totalCapacity
+                  << " tons | " << view.cargoCount << " cargo items\n";
+        std::cout << "=====================================\n";
+    }
+
+    // ── forEachTrain — insertion order, fn(id, name, maxWeight, version) ─────
+    // Runs on a snapshot(): no locks are held while fn runs.
+    template <typename Fn>
+    void forEachTrain(Fn fn) const {
+        for (const TrainView& train : snapshot().trains)
+            fn(train.id(), train.name(), train.maxWeight(), train.manifest());
+    }
+
+    int getSize() const { return size; }
+
+    long long getTotalWeight() const   { return totalWeight; }
+    long long getTotalCapacity() const { return totalCapacity; }
+    long long getCargoCount() const    { return cargoCount; }
+
+    int getRemainingCapacity(KeyView trainId) const {
+        TrainPtr train = findTrain(trainId);
+        if (train == nullptr || train->removed) return -1;
+        return train->maxWeight - train->cargo.snapshot()->getTotalWeight();
+    }
+};
+
+#endif
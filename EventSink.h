@@ -0,0 +1,285 @@
+#ifndef EVENTSINK_H
+#define EVENTSINK_H
+
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "FdWriter.h"
+
+// ── OpResult — outcome of every container mutation ───────────────────────────
+enum class OpResult {
+    Ok,
+    TrainNotFound,
+    CargoNotFound,
+    StationNotFound,
+    Overweight,
+    DuplicateId,
+    RouteEmpty,
+    InvalidArgument,
+    JournalFailed
+};
+
+inline const char* toString(OpResult r) {
+    switch (r) {
+        case OpResult::Ok:              return "ok";
+        case OpResult::TrainNotFound:   return "train not found";
+        case OpResult::CargoNotFound:   return "cargo not found";
+        case OpResult::StationNotFound: return "station not found";
+        case OpResult::Overweight:      return "overweight";
+        case OpResult::DuplicateId:     return "duplicate id";
+        case OpResult::RouteEmpty:      return "route empty";
+        case OpResult::InvalidArgument: return "invalid argument";
+        case OpResult::JournalFailed:   return "journal write failed";
+    }
+    return "unknown";
+}
+
+// ── textOf — view any key/name type as text ──────────────────────────────────
+// Strings and string views are viewed in place; other types go through
+// operator<<.
+inline std::string_view textOf(const std::string& s) { return s; }
+inline std::string_view textOf(std::string_view s) { return s; }
+
+template <typename T>
+std::string textOf(const T& value) {
+    std::ostringstream os;
+    os << value;
+    return os.str();
+}
+
+// ── EventKind — one per message the containers used to print ─────────────────
+enum class EventKind : std::uint8_t {
+    CargoLoaded,         // subject = cargo name, extra = type, value = weight
+    CargoUnloaded,       // subject = cargo name
+    CargoNotFound,       // subject = cargo name
+    TrainAdded,          // subject = id, detail = name, value = maxWeight
+    TrainExists,         // subject = id
+    TrainRemoved,        // subject = id, detail = name
+    TrainIdNotFound,     // subject = id (removeTrain wording)
+    TrainNotFound,       // subject = id
+    Overweight,          // subject = train id, detail = cargo name, value/limit = tons
+    BatchOverweight,     // subject = train id, value/limit = tons
+    TrainLoading,        // subject = train id
+    TrainUnloading,      // subject = train id
+    StationAdded,        // subject = station
+    StationRemoved,      // subject = station
+    LastStationRemoved,  // subject = station
+    StationNotFound,     // subject = station
+    RouteEmpty,          // (removeStation on an empty route)
+    NoStations,          // (advanceStation on an empty route)
+    FleetArrived,        // subject = station
+    StationExists,       // subject = station
+    CargoReweighed       // subject = cargo name, value = new weight
+};
+
+// ── Event — borrowed view of one mutation, valid only during emit() ──────────
+template <typename T>
+struct Event {
+    EventKind kind;
+    const T*  subject = nullptr;
+    const T*  detail  = nullptr;
+    const T*  extra   = nullptr;
+    long long value   = 0;
+    long long limit   = 0;
+};
+
+// ── formatEvent — append the classic console text for an event ──────────────
+template <typename T>
+void formatEvent(std::string& out, const Event<T>& e) {
+    auto text = [&out](const T* v) { if (v != nullptr) out += textOf(*v); };
+    auto num  = [&out](long long v) {
+        char tmp[24];
+        auto res = std::to_chars(tmp, tmp + sizeof tmp, v);
+        out.append(tmp, res.ptr);
+    };
+
+    switch (e.kind) {
+        case EventKind::CargoLoaded:
+            out += "  [Loaded]   \""; text(e.subject); out += "\" (";
+            text(e.extra); out += ", "; num(e.value); out += " tons)\n";
+            break;
+        case EventKind::CargoUnloaded:
+            out += "  [Unloaded] \""; text(e.subject); out += "\"\n";
+            break;
+        case EventKind::CargoNotFound:
+            out += "  [Error] Cargo \""; text(e.subject); out += "\" not found.\n";
+            break;
+        case EventKind::TrainAdded:
+            out += "[Fleet] Train added: ["; text(e.subject); out += "] ";
+            text(e.detail); out += " (max "; num(e.value); out += " tons)\n";
+            break;
+        case EventKind::TrainExists:
+            out += "[Fleet] Train ID \""; text(e.subject); out += "\" already exists.\n";
+            break;
+        case EventKind::TrainRemoved:
+            out += "[Fleet] Train removed: ["; text(e.subject); out += "] ";
+            text(e.detail); out += "\n";
+            break;
+        case EventKind::TrainIdNotFound:
+            out += "[Fleet] Train ID \""; text(e.subject); out += "\" not found.\n";
+            break;
+        case EventKind::TrainNotFound:
+            out += "[Fleet] Train \""; text(e.subject); out += "\" not found.\n";
+            break;
+        case EventKind::Overweight:
+            out += "  [Overweight] Cannot load \""; text(e.detail);
+            out += "\". Would exceed max weight ("; num(e.value); out += "/";
+            num(e.limit); out += " tons).\n";
+            break;
+        case EventKind::BatchOverweight:
+            out += "  [Overweight] Cannot load batch onto \""; text(e.subject);
+            out += "\". Would exceed max weight ("; num(e.value); out += "/";
+            num(e.limit); out += " tons).\n";
+            break;
+        case EventKind::TrainLoading:
+            out += "[Train "; text(e.subject); out += "] Loading cargo:\n";
+            break;
+        case EventKind::TrainUnloading:
+            out += "[Train "; text(e.subject); out += "] Unloading cargo:\n";
+            break;
+        case EventKind::StationAdded:
+            out += "[Route] Station added: \""; text(e.subject); out += "\"\n";
+            break;
+        case EventKind::StationRemoved:
+            out += "[Route] Removed station \""; text(e.subject); out += "\"\n";
+            break;
+        case EventKind::LastStationRemoved:
+            out += "[Route] Removed last station \""; text(e.subject);
+            out += "\". Route is now empty.\n";
+            break;
+        case EventKind::StationNotFound:
+            out += "[Route] Station \""; text(e.subject); out += "\" not found.\n";
+            break;
+        case EventKind::RouteEmpty:
+            out += "[Route] Route is empty.\n";
+            break;
+        case EventKind::NoStations:
+            out += "[Route] No stations on route.\n";
+            break;
+        case EventKind::FleetArrived:
+            out += "[Route] Fleet arrived at: \""; text(e.subject); out += "\"\n";
+            break;
+        case EventKind::StationExists:
+            out += "[Route] Station \""; text(e.subject); out += "\" already exists.\n";
+            break;
+        case EventKind::CargoReweighed:
+            out += "  [Updated]  \""; text(e.subject); out += "\" (now ";
+            num(e.value); out += " tons)\n";
+            break;
+    }
+}
+
+// ── EventSink — where containers send their mutation events ──────────────────
+// Containers hold an EventSink<T>*; nullptr means silent, and no event is even
+// constructed. Errors are reported through OpResult regardless of the sink.
+template <typename T>
+class EventSink {
+public:
+    virtual ~EventSink() = default;
+    virtual void emit(const Event<T>& e) = 0;
+    virtual void flush() {}
+};
+
+// ── NullSink — swallow everything ────────────────────────────────────────────
+template <typename T>
+class NullSink : public EventSink<T> {
+public:
+    void emit(const Event<T>&) override {}
+};
+
+// ── ConsoleSink — the original behaviour: one std::cout write per event ──────
+template <typename T>
+class ConsoleSink : public EventSink<T> {
+private:
+    std::string line;
+
+public:
+    void emit(const Event<T>& e) override {
+        line.clear();
+        formatEvent(line, e);
+        std::cout << line;
+    }
+
+    void flush() override { std::cout.flush(); }
+};
+
+// Shared default sink for every container of a given T.
+template <typename T>
+EventSink<T>* consoleSink() {
+    static ConsoleSink<T> sink;
+    return &sink;
+}
+
+// ── BufferedTextSink — same text, batched into large writes to an fd ─────────
+template <typename T>
+class BufferedTextSink : public EventSink<T> {
+private:
+    FdWriter    out;
+    std::string line;
+
+public:
+    explicit BufferedTextSink(int fd, std::size_t bufferBytes = 1 << 16)
+        : out(fd, bufferBytes) {}
+
+    void emit(const Event<T>& e) override {
+        line.clear();
+        formatEvent(line, e);
+        out.append(line);
+    }
+
+    void flush() override { out.flush(); }
+};
+
+// ── BinaryEventSink — compact binary records to an fd ────────────────────────
+// Record layout (lengths are LEB128 varints, value/limit zigzag varints):
+//   u8 kind | u8 mask | [len, bytes] subject/detail/extra | value | limit
+// mask bits 0..2 flag which strings follow, bit 3 value, bit 4 limit.
+template <typename T>
+class BinaryEventSink : public EventSink<T> {
+private:
+    FdWriter    out;
+    std::string rec;
+
+    void putVarint(std::uint64_t v) {
+        while (v >= 0x80) {
+            rec += static_cast<char>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        rec += static_cast<char>(v);
+    }
+
+    void putSigned(long long v) {
+        putVarint((static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+    }
+
+    void putText(const T& v) {
+        const auto s = textOf(v);
+        putVarint(s.size());
+        rec.append(s.data(), s.size());
+    }
+
+public:
+    explicit BinaryEventSink(int fd, std::size_t bufferBytes = 1 << 16)
+        : out(fd, bufferBytes) {}
+
+    void emit(const Event<T>& e) override {
+        std::uint8_t mask = (e.subject ? 1 : 0) | (e.detail ? 2 : 0) | (e.extra ? 4 : 0)
+                          | (e.value ? 8 : 0)  | (e.limit ? 16 : 0);
+        rec.clear();
+        rec += static_cast<char>(e.kind);
+        rec += static_cast<char>(mask);
+        if (e.subject) putText(*e.subject);
+        if (e.detail)  putText(*e.detail);
+        if (e.extra)   putText(*e.extra);
+        if (e.value)   putSigned(e.value);
+        if (e.limit)   putSigned(e.limit);
+        out.append(rec);
+    }
+
+    void flush() override { out.flush(); }
+};
+
+#endif
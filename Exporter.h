@@ -0,0 +1,329 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "EventSink.h"
+#include "FdWriter.h"
+
+// ── Exporter — stream fleet, manifests and route to a file descriptor ────────
+// Rows are formatted straight into one large FdWriter buffer (integers with
+// std::to_chars, strings by memcpy plus escaping where the format needs it)
+// and leave in big write(2) calls, instead of the display functions' many
+// small operator<< calls per field.
+//
+// Formats:
+//   Csv       — header line, then RFC 4180 rows (fields quoted when needed)
+//   JsonLines — one JSON object per line
+//   Table     — fixed-width columns for people (long values just overflow)
+//
+// Exports:
+//   cargo(fleet)  — one row per item: train, cargo, type, weight
+//   fleet(fleet)  — one row per train: train, name, load, capacity, items
+//   route(route)  — one row per station: position, station, current
+//
+// ExportFilter narrows the rows (train ID, cargo type, weight range; the last
+// two apply to cargo only) and pages them with offset/limit, counted after
+// filtering. When a cargo export has no item filter, whole manifests inside
+// the offset are skipped by their count without being walked.
+//
+// The fleet needs forEachTrain() (TrainFleet, ConcurrentFleet — which exports
+// a lock-free snapshot — and JournaledFleet); the route needs
+// forEachStation() and getCurrentIndex().
+enum class ExportFormat : std::uint8_t { Csv, JsonLines, Table };
+
+inline bool parseExportFormat(std::string_view text, ExportFormat& format) {
+    if      (text == "csv")   format = ExportFormat::Csv;
+    else if (text == "jsonl") format = ExportFormat::JsonLines;
+    else if (text == "table") format = ExportFormat::Table;
+    else return false;
+    return true;
+}
+
+template <typename T>
+struct ExportFilter {
+    static constexpr std::size_t kNoLimit = std::numeric_limits<std::size_t>::max();
+
+    std::optional<T> train;  // only this train
+    std::optional<T> type;   // only this cargo type
+    int minWeight = std::numeric_limits<int>::min();
+    int maxWeight = std::numeric_limits<int>::max();
+    std::size_t offset = 0;         // matching rows to skip
+    std::size_t limit  = kNoLimit;  // matching rows to write
+
+    bool filtersItems() const {
+        return type.has_value() || minWeight != std::numeric_limits<int>::min()
+            || maxWeight != std::numeric_limits<int>::max();
+    }
+};
+
+// ── ExportStats — what one export wrote ──────────────────────────────────────
+struct ExportStats {
+    std::size_t rows  = 0;      // rows written (header not counted)
+    std::size_t bytes = 0;      // bytes written, header included
+    bool        more  = false;  // further matching rows exist past the page
+    bool        ok    = true;   // false if a write failed
+};
+
+template <typename T>
+class Exporter {
+private:
+    struct Column {
+        const char* name;
+        int         width;  // Table only; negative = right-aligned
+    };
+
+    FdWriter     out;
+    ExportFormat format;
+
+    // ── Page — offset/limit bookkeeping for one export ───────────────────────
+    struct Page {
+        std::size_t skip;
+        std::size_t left;
+        bool        more = false;
+
+        explicit Page(const ExportFilter<T>& f) : skip(f.offset), left(f.limit) {}
+
+        // True if this matching row should be written.
+        bool take() {
+            if (skip > 0) { skip--; return false; }
+            if (left == 0) { more = true; return false; }
+            left--;
+            return true;
+        }
+        bool done() const { return left == 0 && more; }
+    };
+
+    void pad(std::size_t n) {
+        for (; n > 0; --n) out.put(' ');
+    }
+
+    void csvText(std::string_view s) {
+        if (s.find_first_of(",\"\r\n") == std::string_view::npos) {
+            out.append(s);
+            return;
+        }
+        out.put('"');
+        for (char c : s) {
+            if (c == '"') out.put('"');
+            out.put(c);
+        }
+        out.put('"');
+    }
+
+    void jsonText(std::string_view s) {
+        static const char kHex[] = "0123456789abcdef";
+        out.put('"');
+        std::size_t run = 0;  // plain characters are copied in runs
+        for (std::size_t i = 0; i < s.size(); ++i) {
+            const unsigned char c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            out.put('\\');
+            switch (c) {
+                case '"':  out.put('"');  break;
+                case '\\': out.put('\\'); break;
+                case '\n': out.put('n');  break;
+                case '\r': out.put('r');  break;
+                case '\t': out.put('t');  break;
+                default:
+                    out.append("u00", 3);
+                    out.put(kHex[c >> 4]);
+                    out.put(kHex[c & 0xF]);
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out.put('"');
+    }
+
+    // ── Row building — begin(), one field() per column, end() ───────────────
+    void begin() {
+        if (format == ExportFormat::JsonLines) out.put('{');
+    }
+
+    void separator(bool first) {
+        if (!first) out.put(format == ExportFormat::Table ? ' ' : ',');
+    }
+
+    void key(const Column& col) {
+        if (format != ExportFormat::JsonLines) return;
+        out.put('"');
+        out.append(col.name);
+        out.append("\":", 2);
+    }
+
+    void field(const Column& col, bool first, std::string_view s) {
+        separator(first);
+        key(col);
+        switch (format) {
+            case ExportFormat::Csv:       csvText(s);  break;
+            case ExportFormat::JsonLines: jsonText(s); break;
+            case ExportFormat::Table: {
+                const std::size_t w = static_cast<std::size_t>(col.width < 0 ? -col.width : col.width);
+                if (col.width < 0 && s.size() < w) pad(w - s.size());
+                out.append(s);
+                if (col.width > 0 && s.size() < w) pad(w - s.size());
+                break;
+            }
+        }
+    }
+
+    void field(const Column& col, bool first, long long v) {
+        separator(first);
+        key(col);
+        if (format == ExportFormat::Table) {
+            char tmp[24];
+            auto res = std::to_chars(tmp, tmp + sizeof tmp, v);
+            const std::size_t n = static_cast<std::size_t>(res.ptr - tmp);
+            const std::size_t w = static_cast<std::size_t>(col.width < 0 ? -col.width : col.width);
+            if (col.width < 0 && n < w) pad(w - n);
+            out.append(tmp, n);
+            if (col.width > 0 && n < w) pad(w - n);
+        } else {
+            out.appendInt(v);
+        }
+    }
+
+    void field(const Column& col, bool first, bool v) {
+        if (format == ExportFormat::JsonLines) {
+            separator(first);
+            key(col);
+            out.append(v ? std::string_view("true") : std::string_view("false"));
+        } else {
+            field(col, first, static_cast<long long>(v ? 1 : 0));
+        }
+    }
+
+    void end() {
+        if (format == ExportFormat::JsonLines) out.put('}');
+        out.put('\n');
+    }
+
+    template <std::size_t N>
+    void header(const Column (&cols)[N]) {
+        if (format == ExportFormat::JsonLines) return;
+        for (std::size_t i = 0; i < N; ++i) field(cols[i], i == 0, std::string_view(cols[i].name));
+        out.put('\n');
+        if (format != ExportFormat::Table) return;
+        for (std::size_t i = 0; i < N; ++i) {
+            if (i != 0) out.put(' ');
+            const int w = cols[i].width < 0 ? -cols[i].width : cols[i].width;
+            for (int k = 0; k < w; ++k) out.put('-');
+        }
+        out.put('\n');
+    }
+
+    ExportStats finish(const Page& page, std::size_t rows, std::size_t startBytes) {
+        out.flush();
+        ExportStats st;
+        st.rows  = rows;
+        st.bytes = out.bytesWritten() - startBytes;
+        st.more  = page.more;
+        st.ok    = out.ok();
+        return st;
+    }
+
+public:
+    // The descriptor stays open; bufferBytes is the single output buffer.
+    explicit Exporter(int fd, ExportFormat format, std::size_t bufferBytes = 1 << 20)
+        : out(fd, bufferBytes), format(format) {}
+
+    // Rows are appended to `sink` instead (for front-ends that frame replies).
+    Exporter(std::string& sink, ExportFormat format, std::size_t bufferBytes = 1 << 16)
+        : out(sink, bufferBytes), format(format) {}
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+    // ── cargo — one row per loaded item, fleet order then manifest order ─────
+    template <typename Fleet>
+    ExportStats cargo(const Fleet& fleet, const ExportFilter<T>& filter = ExportFilter<T>()) {
+        static const Column cols[] = {{"train", 12}, {"cargo", 24}, {"type", 16}, {"weight", -8}};
+        out.flush();
+        const std::size_t startBytes = out.bytesWritten();
+        header(cols);
+        Page page(filter);
+        std::size_t rows = 0;
+        const bool itemFilter = filter.filtersItems();
+        fleet.forEachTrain([&](const T& id, const T&, int, const auto& manifest) {
+            if (page.done() || (filter.train && !(id == *filter.train))) return;
+            if (!itemFilter && page.skip >= static_cast<std::size_t>(manifest.getCount())) {
+                page.skip -= static_cast<std::size_t>(manifest.getCount());
+                return;
+            }
+            manifest.forEach([&](const T& name, const T& type, int weight) {
+                if (itemFilter && ((filter.type && !(type == *filter.type))
+                                   || weight < filter.minWeight || weight > filter.maxWeight))
+                    return;
+                if (!page.take()) return;
+                begin();
+                field(cols[0], true, textOf(id));
+                field(cols[1], false, textOf(name));
+                field(cols[2], false, textOf(type));
+                field(cols[3], false, static_cast<long long>(weight));
+                end();
+                rows++;
+            });
+        });
+        return finish(page, rows, startBytes);
+    }
+
+    // ── fleet — one row per train with its load ─────────────────────────────
+    template <typename Fleet>
+    ExportStats fleet(const Fleet& fleet, const ExportFilter<T>& filter = ExportFilter<T>()) {
+        static const Column cols[] = {{"train", 12}, {"name", 24}, {"load", -10},
+                                      {"capacity", -10}, {"items", -8}};
+        out.flush();
+        const std::size_t startBytes = out.bytesWritten();
+        header(cols);
+        Page page(filter);
+        std::size_t rows = 0;
+        fleet.forEachTrain([&](const T& id, const T& name, int maxWeight, const auto& manifest) {
+            if (page.done() || (filter.train && !(id == *filter.train)) || !page.take()) return;
+            begin();
+            field(cols[0], true, textOf(id));
+            field(cols[1], false, textOf(name));
+            field(cols[2], false, static_cast<long long>(manifest.getTotalWeight()));
+            field(cols[3], false, static_cast<long long>(maxWeight));
+            field(cols[4], false, static_cast<long long>(manifest.getCount()));
+            end();
+            rows++;
+        });
+        return finish(page, rows, startBytes);
+    }
+
+    // ── route — one row per station from head; current marks the fleet ──────
+    template <typename Route>
+    ExportStats route(const Route& route, const ExportFilter<T>& filter = ExportFilter<T>()) {
+        static const Column cols[] = {{"position", -8}, {"station", 24}, {"current", -7}};
+        out.flush();
+        const std::size_t startBytes = out.bytesWritten();
+        header(cols);
+        Page page(filter);
+        std::size_t rows = 0;
+        const long long current = route.getCurrentIndex();
+        long long position = 0;
+        route.forEachStation([&](const T& name) {
+            const long long at = position++;
+            if (page.done() || !page.take()) return;
+            begin();
+            field(cols[0], true, at);
+            field(cols[1], false, textOf(name));
+            field(cols[2], false, at == current);
+            end();
+            rows++;
+        });
+        return finish(page, rows, startBytes);
+    }
+
+    void flush() { out.flush(); }
+    bool ok() const { return out.ok(); }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef FDWRITER_H
+#define FDWRITER_H
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+
+// ── FdWriter — large reusable output buffer in front of a file descriptor ────
+// Appends are memcpy into the buffer; the buffer goes out with one write(2)
+// when full or on flush(), so thousands of small records cost one syscall.
+// Built on a std::string instead of a descriptor, flushes append to it.
+//
+// Functions:
+//   append(data, n) / append(string_view) / put(char)
+//   appendInt()     — std::to_chars straight into the buffer
+//   flush()         — write out everything buffered (retries short writes)
+//   bytesWritten()  — total bytes handed to the descriptor so far
+class FdWriter {
+private:
+    int fd;
+    std::string* sink;  // flush target instead of fd when set
+    std::vector<char> buf;
+    std::size_t used;
+    std::size_t written;
+    bool failed;
+
+    void writeAll(const char* data, std::size_t n) {
+        if (sink != nullptr) {
+            sink->append(data, n);
+            written += n;
+            return;
+        }
+        while (n > 0 && !failed) {
+            ssize_t r = ::write(fd, data, n);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                failed = true;
+                return;
+            }
+            data    += r;
+            n       -= static_cast<std::size_t>(r);
+            written += static_cast<std::size_t>(r);
+        }
+    }
+
+public:
+    explicit FdWriter(int fd, std::size_t capacity = 1 << 16)
+        : fd(fd), sink(nullptr), buf(capacity), used(0), written(0), failed(false) {}
+
+    explicit FdWriter(std::string& sink, std::size_t capacity = 1 << 16)
+        : fd(-1), sink(&sink), buf(capacity), used(0), written(0), failed(false) {}
+
+    ~FdWriter() { flush(); }
+
+    FdWriter(const FdWriter&) = delete;
+    FdWriter& operator=(const FdWriter&) = delete;
+
+    void append(const char* data, std::size_t n) {
+        if (used + n > buf.size()) {
+            flush();
+            if (n >= buf.size()) {   // too big to buffer — write straight through
+                writeAll(data, n);
+                return;
+            }
+        }
+        std::memcpy(buf.data() + used, data, n);
+        used += n;
+    }
+
+    void append(std::string_view s) { append(s.data(), s.size()); }
+
+    void put(char c) {
+        if (used == buf.size()) flush();
+        buf[used++] = c;
+    }
+
+    template <typename Int>
+    void appendInt(Int value) {
+        if (buf.size() - used < 24) flush();
+        auto res = std::to_chars(buf.data() + used, buf.data() + buf.size(), value);
+        used = static_cast<std::size_t>(res.ptr - buf.data());
+    }
+
+    void flush() {
+        if (used == 0) return;
+        writeAll(buf.data(), used);
+        used = 0;
+    }
+
+    int  getFd() const { return fd; }
+    bool ok() const { return !failed; }
+    std::size_t bytesWritten() const { return written; }
+};
+
+#endif
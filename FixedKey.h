@@ -0,0 +1,177 @@
+#ifndef FIXEDKEY_H
+#define FIXEDKEY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "KeyTraits.h"
+
+// ── FixedKey — up to N bytes of text packed into 64-bit words ────────────────
+// For IDs with a known maximum length ("T-0042"): no heap, no pointer, and
+// every operation is integer arithmetic on ceil(N / 8) words — one word for
+// FixedKey<8>. Bytes are packed big-endian (the first character in the top
+// byte) and zero-padded, so comparing the words in order compares the text
+// lexicographically, and ordered containers sort exactly as with std::string.
+//
+// Construction, comparison and hashing are constexpr, so keys written as
+// literals are packed at compile time.
+//
+// Text longer than N bytes throws std::length_error. NUL bytes are padding,
+// so a key cannot contain them. Containers take lookup keys as a
+// FixedKeyView (below), which never throws: over-long text is simply not
+// found.
+//
+// Usable as the T of every container or as a FleetPolicy Id (FleetPolicy.h):
+// implicitly constructible from strings, string views and literals,
+// hashable, printable and viewable through textOf().
+template <std::size_t N>
+class FixedKey {
+private:
+    static_assert(N > 0, "FixedKey needs room for at least one byte");
+    static constexpr std::size_t kWords = (N + 7) / 8;
+
+    std::uint64_t words[kWords];
+
+    static constexpr unsigned shiftOf(std::size_t i) { return static_cast<unsigned>(56 - 8 * (i % 8)); }
+
+public:
+    static constexpr std::size_t kCapacity = N;
+
+    constexpr FixedKey() : words{} {}
+
+    static constexpr bool fits(std::string_view s) { return s.size() <= N; }
+
+    // A NUL followed by a non-NUL byte, which no text packs to: equal to no
+    // key that can be stored. FixedKeyView uses it for over-long text.
+    static constexpr FixedKey unmatchable() {
+        FixedKey k;
+        k.words[kWords - 1] = 1;
+        return k;
+    }
+
+    constexpr FixedKey(std::string_view s) : words{} {
+        if (s.size() > N) throw std::length_error("FixedKey: text longer than the key");
+        for (std::size_t i = 0; i < s.size(); ++i)
+            words[i / 8] |= std::uint64_t(static_cast<unsigned char>(s[i])) << shiftOf(i);
+    }
+
+    constexpr FixedKey(const char* s) : FixedKey(std::string_view(s)) {}
+    FixedKey(const std::string& s) : FixedKey(std::string_view(s)) {}
+
+    constexpr std::size_t size() const {
+        std::size_t n = 0;
+        while (n < N && ((words[n / 8] >> shiftOf(n)) & 0xFF) != 0) n++;
+        return n;
+    }
+
+    constexpr bool empty() const { return words[0] == 0; }
+
+    // Writes the text to out (room for N bytes), returns its length.
+    constexpr std::size_t copyTo(char* out) const {
+        const std::size_t n = size();
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = static_cast<char>((words[i / 8] >> shiftOf(i)) & 0xFF);
+        return n;
+    }
+
+    std::string str() const {
+        char text[N];
+        return std::string(text, copyTo(text));
+    }
+
+    // splitmix64 finaliser over the words: integer multiplies and shifts only.
+    constexpr std::size_t hash() const {
+        std::uint64_t h = 0;
+        for (std::size_t i = 0; i < kWords; ++i) {
+            h ^= words[i] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+            h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+            h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+            h ^= h >> 31;
+        }
+        return static_cast<std::size_t>(h);
+    }
+
+    friend constexpr bool operator==(const FixedKey& a, const FixedKey& b) {
+        for (std::size_t i = 0; i < kWords; ++i)
+            if (a.words[i] != b.words[i]) return false;
+        return true;
+    }
+    friend constexpr bool operator!=(const FixedKey& a, const FixedKey& b) { return !(a == b); }
+    friend constexpr bool operator<(const FixedKey& a, const FixedKey& b) {
+        for (std::size_t i = 0; i < kWords; ++i)
+            if (a.words[i] != b.words[i]) return a.words[i] < b.words[i];
+        return false;
+    }
+    friend constexpr bool operator>(const FixedKey& a, const FixedKey& b)  { return b < a; }
+    friend constexpr bool operator<=(const FixedKey& a, const FixedKey& b) { return !(b < a); }
+    friend constexpr bool operator>=(const FixedKey& a, const FixedKey& b) { return !(a < b); }
+
+    friend std::ostream& operator<<(std::ostream& os, const FixedKey& k) {
+        char text[N];
+        return os.write(text, static_cast<std::streamsize>(k.copyTo(text)));
+    }
+};
+
+// ── FixedKeyView — the lookup parameter type for FixedKey (KeyTraits::View) ──
+// Converts from a FixedKey, or from text without throwing: text longer than N
+// bytes becomes FixedKey::unmatchable(), so a lookup reports "not found"
+// (TrainNotFound, StationNotFound, ...) and the text is kept for the event.
+// Converts back to const FixedKey&, which is what the indexes probe with.
+template <std::size_t N>
+class FixedKeyView {
+private:
+    FixedKey<N>      k;
+    std::string_view overLong;  // the text when it does not fit, else empty
+
+public:
+    constexpr FixedKeyView(const FixedKey<N>& key) : k(key), overLong() {}
+    constexpr FixedKeyView(std::string_view s)
+        : k(FixedKey<N>::fits(s) ? FixedKey<N>(s) : FixedKey<N>::unmatchable()),
+          overLong(FixedKey<N>::fits(s) ? std::string_view() : s) {}
+    constexpr FixedKeyView(const char* s) : FixedKeyView(std::string_view(s)) {}
+    FixedKeyView(const std::string& s) : FixedKeyView(std::string_view(s)) {}
+
+    constexpr operator const FixedKey<N>&() const { return k; }
+    constexpr const FixedKey<N>& key() const { return k; }
+
+    std::string str() const { return overLong.empty() ? k.str() : std::string(overLong); }
+
+    friend constexpr bool operator==(const FixedKeyView& a, const FixedKeyView& b) { return a.k == b.k; }
+    friend constexpr bool operator!=(const FixedKeyView& a, const FixedKeyView& b) { return a.k != b.k; }
+
+    friend std::ostream& operator<<(std::ostream& os, const FixedKeyView& v) {
+        if (!v.overLong.empty()) return os << v.overLong;
+        return os << v.k;
+    }
+};
+
+template <std::size_t N>
+struct KeyTraits<FixedKey<N>> {
+    using View     = const FixedKeyView<N>&;
+    using IndexKey = FixedKey<N>;
+};
+
+// Picked over the generic textOf() in EventSink.h: no ostringstream.
+template <std::size_t N>
+std::string textOf(const FixedKey<N>& k) { return k.str(); }
+
+template <std::size_t N>
+std::string textOf(const FixedKeyView<N>& v) { return v.str(); }
+
+namespace std {
+template <std::size_t N>
+struct hash<FixedKey<N>> {
+    constexpr std::size_t operator()(const FixedKey<N>& k) const noexcept { return k.hash(); }
+};
+
+template <std::size_t N>
+struct hash<FixedKeyView<N>> {
+    constexpr std::size_t operator()(const FixedKeyView<N>& v) const noexcept { return v.key().hash(); }
+};
+}  // namespace std
+
+#endif
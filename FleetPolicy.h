@@ -0,0 +1,72 @@
+#ifndef FLEETPOLICY_H
+#define FLEETPOLICY_H
+
+#include <limits>
+#include <type_traits>
+
+// ── FleetPolicy — the key and weight types a fleet is built on ───────────────
+// Cargo, CargoList, CargoArray, TrainFleet and RouteLoop take either one type
+// T, used for IDs, names and types with int weights (as they always have), or
+// a policy naming the three separately:
+//   Id     — train IDs: the fleet's hash index and every lookup by train
+//   Name   — train, cargo, type and station names; also the text type of
+//            events (EventSink<Name>)
+//   Weight — tons per item, per-train totals and capacities; a signed
+//            integer type of at most 64 bits (fleet-wide aggregates are long
+//            long). For fixed-point tonnage, count a smaller unit
+//            (kilograms, say) in a 64-bit Weight.
+//
+// For example FleetPolicy<FixedKey<8>, std::string, long long> gives 8-byte
+// packed train IDs (FixedKey.h), so finding a train hashes and compares
+// integers, with string names and 64-bit weights.
+//
+// Any type with Id, Name and Weight member types is a policy (PolicyTraits
+// detects them); anything else is a plain T.
+template <typename IdT, typename NameT = IdT, typename WeightT = int>
+struct FleetPolicy {
+    using Id     = IdT;
+    using Name   = NameT;
+    using Weight = WeightT;
+};
+
+template <typename T, typename = void>
+struct PolicyTraits {
+    using Id     = T;
+    using Name   = T;
+    using Weight = int;
+};
+
+template <typename P>
+struct PolicyTraits<P, std::void_t<typename P::Id, typename P::Name, typename P::Weight>> {
+    using Id     = typename P::Id;
+    using Name   = typename P::Name;
+    using Weight = typename P::Weight;
+    static_assert(std::is_integral<Weight>::value && std::is_signed<Weight>::value &&
+                  sizeof(Weight) <= sizeof(long long),
+                  "FleetPolicy: Weight must be a signed integer type of at most 64 bits");
+};
+
+template <typename T> using IdOf     = typename PolicyTraits<T>::Id;
+template <typename T> using NameOf   = typename PolicyTraits<T>::Name;
+template <typename T> using WeightOf = typename PolicyTraits<T>::Weight;
+
+// ── addWeight / subWeight — overflow-checked weight arithmetic ───────────────
+// Return false when the exact result does not fit in W, with out clamped to
+// W's limit in the direction of the overflow (so a reported total is still
+// meaningful). TrainFleet's capacity checks sum through these, so a load whose
+// total does not fit is rejected as Overweight instead of wrapping around.
+template <typename W>
+inline bool addWeight(W a, W b, W& out) {
+    if (!__builtin_add_overflow(a, b, &out)) return true;
+    out = b > 0 ? std::numeric_limits<W>::max() : std::numeric_limits<W>::min();
+    return false;
+}
+
+template <typename W>
+inline bool subWeight(W a, W b, W& out) {
+    if (!__builtin_sub_overflow(a, b, &out)) return true;
+    out = b < 0 ? std::numeric_limits<W>::max() : std::numeric_limits<W>::min();
+    return false;
+}
+
+#endif
@@ -0,0 +1,612 @@
+#ifndef FLEETSERVER_H
+#define FLEETSERVER_H
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "BatchRunner.h"
+#include "EventSink.h"
+#include "MpscQueue.h"
+
+// ── ServerOptions — where to listen and how to split the work ────────────────
+struct ServerOptions {
+    std::string unixPath;                 // Unix socket path (an old socket file is replaced)
+    int         tcpPort       = -1;       // 127.0.0.1:port when >= 0; 0 picks a free port
+    unsigned    ioThreads     = 1;        // epoll loops; 0 = one per core
+    std::size_t maxBatchBytes = 1 << 20;  // request text applied between replies
+};
+
+// ── ServerStats — totals for one run, complete after stop() ──────────────────
+struct ServerStats {
+    long long connections = 0;
+    long long lines       = 0;  // command lines answered
+    long long batches     = 0;  // owner wake-ups that applied something
+};
+
+// ── FleetServer — many socket clients, one owner thread for the containers ───
+// Speaks the batch command language (BatchRunner.h) over a Unix or localhost
+// TCP socket. Clients may pipeline: send any number of lines without waiting.
+// Blank and '#' lines get no reply; every other line gets exactly one, in
+// order:
+//
+//   OK <n>\n<n bytes>               applied; n bytes of output (FLEET, EXPORT...)
+//   FAIL <n> <result>\n<n bytes>    applied, returned a non-Ok OpResult
+//   ERR <n> <message>\n<n bytes>    not parsed
+//
+// QUIT is answered OK; the connection closes once every earlier reply has
+// been written, and nothing after it is applied. A line longer than 1 MiB
+// closes the connection.
+//
+// Threads:
+//   I/O threads — each runs an epoll loop over its own connections (the
+//     listening sockets sit in every loop with EPOLLEXCLUSIVE). Complete lines
+//     from one read burst travel as one Chunk through a lock-free MPSC queue
+//     to the owner; the same Chunk comes back holding the replies.
+//   Owner thread — the only thread touching the fleet and route. It drains
+//     every queued Chunk (up to maxBatchBytes), runs the lines through one
+//     BatchRunner so consecutive LOADs and ADD_STATIONs are applied in
+//     batches, then answers the lot: one queue push per Chunk and one eventfd
+//     write per I/O thread, however many lines were in it.
+//
+// While it runs, the owner thread redirects std::cout into the reply buffer,
+// so nothing else may print to std::cout until stop() returns. Event sinks
+// should be off (events of deferred LOADs would land in a later reply).
+// Connections whose replies pile up stop being read until the client catches
+// up, so one slow reader cannot grow the server without bound.
+template <typename Fleet, typename Route>
+class FleetServer {
+private:
+    static constexpr std::size_t kReadChunk   = 64 * 1024;
+    static constexpr std::size_t kReadBurst   = 256 * 1024;      // per connection per wake-up
+    static constexpr std::size_t kMaxLine     = 1 << 20;
+    static constexpr std::size_t kMaxOutput   = 8u << 20;        // pause reading above this
+    static constexpr int         kMaxInflight = 64;              // chunks at the owner per connection
+    static constexpr int         kMaxEvents   = 256;
+
+    struct IoThread;
+
+    struct Connection {
+        int         fd;
+        IoThread*   io;
+        std::string in;            // bytes after the last complete line
+        std::string out;           // replies not yet written
+        std::size_t outSent  = 0;
+        int         inflight = 0;  // chunks at the owner
+        bool        reading  = true;   // EPOLLIN registered
+        bool        writing  = false;  // EPOLLOUT registered
+        bool        eof      = false;  // peer shut down its side, or QUIT
+        bool        dead     = false;  // socket closed; freed when inflight hits 0
+        bool        quit     = false;  // owner only: QUIT seen, ignore later lines
+
+        Connection(int fd, IoThread* io) : fd(fd), io(io) {}
+    };
+
+    // Request lines on the way to the owner, replies on the way back.
+    struct Chunk : MpscHook {
+        Connection* conn  = nullptr;
+        std::string text;
+        bool        close = false;  // reply contains QUIT's answer
+    };
+
+    struct IoThread {
+        std::size_t index  = 0;
+        int         epfd   = -1;
+        int         wakeFd = -1;
+        std::thread thread;
+        MpscQueue<Chunk>  replies;
+        std::vector<Connection*> conns;   // live ones; dead ones wait in `dying`
+        std::vector<Connection*> dying;
+        std::vector<Chunk*> spare;        // reused chunks (keep their buffers)
+        long long accepted = 0;
+    };
+
+    // Appends everything the owner's std::cout receives to one string.
+    class CaptureBuf : public std::streambuf {
+    private:
+        std::string& text;
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (c != traits_type::eof()) text.push_back(static_cast<char>(c));
+            return traits_type::not_eof(c);
+        }
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            text.append(s, static_cast<std::size_t>(n));
+            return n;
+        }
+
+    public:
+        explicit CaptureBuf(std::string& text) : text(text) {}
+    };
+
+    Fleet& fleet;
+    Route& route;
+    ServerOptions options;
+
+    int listeners[2] = {-1, -1};  // Unix, TCP
+    int boundPort    = -1;
+    std::vector<std::unique_ptr<IoThread>> io;
+
+    MpscQueue<Chunk>  requests;
+    int               ownerWake = -1;
+    std::atomic<bool> ownerSleeping{false};
+    std::atomic<bool> stopOwner{false};
+    std::atomic<bool> stopIo{false};
+    std::thread       owner;
+    bool              running = false;
+    ServerStats       totals;
+
+    static void wake(int fd) {
+        std::uint64_t one = 1;
+        while (::write(fd, &one, sizeof one) < 0 && errno == EINTR) {}
+    }
+
+    static void drainWake(int fd) {
+        std::uint64_t n;
+        while (::read(fd, &n, sizeof n) < 0 && errno == EINTR) {}
+    }
+
+    static bool fail(std::string* error, const std::string& what) {
+        if (error != nullptr) *error = what + ": " + std::strerror(errno);
+        return false;
+    }
+
+    bool listenUnix(std::string* error) {
+        sockaddr_un addr{};
+        if (options.unixPath.size() >= sizeof addr.sun_path) {
+            errno = ENAMETOOLONG;
+            return fail(error, options.unixPath);
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, options.unixPath.c_str(), options.unixPath.size() + 1);
+        int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return fail(error, "socket");
+        ::unlink(options.unixPath.c_str());
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0 || ::listen(fd, SOMAXCONN) < 0) {
+            const int saved = errno;
+            ::close(fd);
+            errno = saved;
+            return fail(error, options.unixPath);
+        }
+        listeners[0] = fd;
+        return true;
+    }
+
+    bool listenTcp(std::string* error) {
+        int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return fail(error, "socket");
+        int on = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(static_cast<std::uint16_t>(options.tcpPort));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof addr;
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0 || ::listen(fd, SOMAXCONN) < 0
+            || ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+            const int saved = errno;
+            ::close(fd);
+            errno = saved;
+            return fail(error, "127.0.0.1:" + std::to_string(options.tcpPort));
+        }
+        listeners[1] = fd;
+        boundPort = ntohs(addr.sin_port);
+        return true;
+    }
+
+    void closeListeners() {
+        for (int& l : listeners) {
+            if (l >= 0) ::close(l);
+            l = -1;
+        }
+        if (!options.unixPath.empty()) ::unlink(options.unixPath.c_str());
+    }
+
+    // ── I/O side ─────────────────────────────────────────────────────────────
+    static void watch(Connection* c) {
+        epoll_event ev{};
+        ev.events   = (c->reading ? EPOLLIN : 0u) | (c->writing ? EPOLLOUT : 0u);
+        ev.data.ptr = c;
+        ::epoll_ctl(c->io->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+    }
+
+    static void closeSocket(Connection* c) {
+        if (c->dead) return;
+        ::epoll_ctl(c->io->epfd, EPOLL_CTL_DEL, c->fd, nullptr);
+        ::close(c->fd);
+        c->dead = true;
+        c->out.clear();
+        IoThread& t = *c->io;
+        for (std::size_t i = 0; i < t.conns.size(); ++i) {
+            if (t.conns[i] != c) continue;
+            t.conns[i] = t.conns.back();
+            t.conns.pop_back();
+            break;
+        }
+        t.dying.push_back(c);
+    }
+
+    // Free connections with nothing left at the owner.
+    static void reap(IoThread& t) {
+        for (std::size_t i = 0; i < t.dying.size();) {
+            if (t.dying[i]->inflight > 0) { ++i; continue; }
+            delete t.dying[i];
+            t.dying[i] = t.dying.back();
+            t.dying.pop_back();
+        }
+    }
+
+    // Reading resumes once the owner and the client have caught up.
+    static void updateInterest(Connection* c) {
+        if (c->dead) return;
+        const bool pending = c->out.size() - c->outSent > 0;
+        const bool read  = !c->eof && c->inflight < kMaxInflight && c->out.size() - c->outSent < kMaxOutput;
+        if (c->eof && !pending && c->inflight == 0) {
+            closeSocket(c);
+            return;
+        }
+        if (read != c->reading || pending != c->writing) {
+            c->reading = read;
+            c->writing = pending;
+            watch(c);
+        }
+    }
+
+    static void flushOut(Connection* c) {
+        while (c->outSent < c->out.size()) {
+            ssize_t w = ::send(c->fd, c->out.data() + c->outSent, c->out.size() - c->outSent, MSG_NOSIGNAL);
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) closeSocket(c);
+                return;
+            }
+            c->outSent += static_cast<std::size_t>(w);
+        }
+        c->out.clear();
+        c->outSent = 0;
+    }
+
+    Chunk* newChunk(IoThread& t) {
+        if (t.spare.empty()) return new Chunk();
+        Chunk* chunk = t.spare.back();
+        t.spare.pop_back();
+        return chunk;
+    }
+
+    // Returns true if a chunk went to the owner.
+    bool readFrom(IoThread& t, Connection* c) {
+        std::size_t burst = 0;
+        while (burst < kReadBurst) {
+            const std::size_t at = c->in.size();
+            c->in.resize(at + kReadChunk);
+            ssize_t r = ::read(c->fd, &c->in[at], kReadChunk);
+            c->in.resize(at + (r > 0 ? static_cast<std::size_t>(r) : 0));
+            if (r > 0) {
+                burst += static_cast<std::size_t>(r);
+                continue;
+            }
+            if (r < 0 && errno == EINTR) continue;
+            if (r == 0) c->eof = true;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeSocket(c);
+                return false;
+            }
+            break;
+        }
+
+        std::size_t cut = c->in.rfind('\n') + 1;  // 0 when there is no complete line
+        if (c->in.size() - cut > kMaxLine) {
+            closeSocket(c);
+            return false;
+        }
+        if (c->eof && cut < c->in.size()) {           // final unterminated line
+            c->in.push_back('\n');
+            cut = c->in.size();
+        }
+        if (cut == 0) {
+            updateInterest(c);
+            return false;
+        }
+        Chunk* chunk = newChunk(t);
+        chunk->conn  = c;
+        chunk->close = false;
+        chunk->text.assign(c->in, 0, cut);
+        c->in.erase(0, cut);
+        c->inflight++;
+        requests.push(chunk);
+        updateInterest(c);
+        return true;
+    }
+
+    void accept(IoThread& t, int listener) {
+        for (int i = 0; i < 16; ++i) {
+            int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;  // EAGAIN: another loop won the race
+            if (listener == listeners[1]) {
+                int on = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+            }
+            Connection* c = new Connection(fd, &t);
+            epoll_event ev{};
+            ev.events   = EPOLLIN;
+            ev.data.ptr = c;
+            ::epoll_ctl(t.epfd, EPOLL_CTL_ADD, fd, &ev);
+            t.conns.push_back(c);
+            t.accepted++;
+        }
+    }
+
+    void deliver(IoThread& t) {
+        while (Chunk* chunk = t.replies.pop()) {
+            Connection* c = chunk->conn;
+            c->inflight--;
+            if (!c->dead) {
+                c->out += chunk->text;
+                if (chunk->close) c->eof = true;
+                flushOut(c);
+                updateInterest(c);
+            }
+            chunk->text.clear();
+            if (chunk->text.capacity() <= kReadBurst * 2) t.spare.push_back(chunk);
+            else delete chunk;
+        }
+    }
+
+    void ioLoop(IoThread& t) {
+        epoll_event events[kMaxEvents];
+        while (!stopIo.load(std::memory_order_acquire)) {
+            int n = ::epoll_wait(t.epfd, events, kMaxEvents, -1);
+            bool sent = false;
+            for (int i = 0; i < n; ++i) {
+                void* tag = events[i].data.ptr;
+                if (tag == &t.wakeFd) {
+                    drainWake(t.wakeFd);
+                    deliver(t);
+                } else if (tag == &listeners[0] || tag == &listeners[1]) {
+                    accept(t, *static_cast<int*>(tag));
+                } else {
+                    Connection* c = static_cast<Connection*>(tag);
+                    if (c->dead) continue;
+                    if (events[i].events & EPOLLOUT) {
+                        flushOut(c);
+                        updateInterest(c);
+                    }
+                    if (!c->dead && c->reading && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                        sent |= readFrom(t, c);
+                    if (events[i].events & (EPOLLHUP | EPOLLERR)) closeSocket(c);  // replies can't arrive
+                }
+            }
+            if (sent && ownerSleeping.exchange(false)) wake(ownerWake);
+            reap(t);  // only here: later events of this round may name a closed connection
+        }
+        deliver(t);  // answers already made; written only if the socket has room
+        while (!t.conns.empty()) closeSocket(t.conns.back());
+        for (Connection* c : t.dying) delete c;
+        t.dying.clear();
+        for (Chunk* chunk : t.spare) delete chunk;
+        t.spare.clear();
+    }
+
+    // ── Owner side ───────────────────────────────────────────────────────────
+    static void appendReply(std::string& out, const LineResult& r, std::string_view body) {
+        const char* status = r.error != nullptr ? "ERR" : r.result == OpResult::Ok ? "OK" : "FAIL";
+        out += status;
+        out += ' ';
+        char num[24];
+        auto res = std::to_chars(num, num + sizeof num, body.size());
+        out.append(num, static_cast<std::size_t>(res.ptr - num));
+        if (r.error != nullptr) {
+            out += ' ';
+            out += r.error;
+        } else if (r.result != OpResult::Ok) {
+            out += ' ';
+            out += toString(r.result);
+        }
+        out += '\n';
+        out.append(body.data(), body.size());
+    }
+
+    void ownerLoop() {
+        BatchRunner<Fleet, Route> runner(fleet, route);
+        std::vector<LineResult> results;
+        std::string captured;
+        CaptureBuf capture(captured);
+        std::streambuf* saved = std::cout.rdbuf(&capture);
+        runner.replyTo(&results);
+
+        struct Line {
+            std::size_t bodyStart, bodyEnd;
+            bool        quit;
+        };
+        std::vector<Chunk*>      batch;
+        std::vector<std::size_t> linesPer;  // per chunk
+        std::vector<Line>        lines;
+        std::vector<bool>        touched(io.size());
+        std::string              reply;
+
+        while (!stopOwner.load(std::memory_order_acquire)) {
+            batch.clear();
+            std::size_t bytes = 0;
+            while (bytes < options.maxBatchBytes) {
+                Chunk* chunk = requests.pop();
+                if (chunk == nullptr) break;
+                bytes += chunk->text.size();
+                batch.push_back(chunk);
+            }
+            if (batch.empty()) {
+                ownerSleeping.exchange(true);  // a full barrier before the re-check
+                Chunk* chunk = requests.pop();  // a push may have raced the flag
+                if (chunk == nullptr) {
+                    drainWake(ownerWake);
+                    ownerSleeping.store(false);
+                    continue;
+                }
+                ownerSleeping.store(false);
+                batch.push_back(chunk);
+            }
+
+            // Apply every line; output is captured per line, results arrive in order.
+            results.clear();
+            captured.clear();
+            lines.clear();
+            linesPer.assign(batch.size(), 0);
+            for (std::size_t b = 0; b < batch.size(); ++b) {
+                Connection* c = batch[b]->conn;
+                std::string_view text = batch[b]->text;
+                while (!text.empty() && !c->quit) {
+                    std::size_t nl = text.find('\n');
+                    std::string_view line = text.substr(0, nl);
+                    text.remove_prefix(nl == std::string_view::npos ? text.size() : nl + 1);
+                    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                    if (line.empty() || line[0] == '#') continue;
+                    const std::size_t start = captured.size();
+                    c->quit = line == "QUIT";
+                    if (!c->quit) {
+                        runner.execute(line);
+                    } else {
+                        runner.finish();  // answer gathered LOADs before QUIT
+                        results.emplace_back();
+                    }
+                    lines.push_back(Line{start, captured.size(), c->quit});
+                    linesPer[b]++;
+                }
+            }
+            runner.finish();  // deferred LOADs / ADD_STATIONs answer here; one journal commit
+
+            // Replace each chunk's requests with its replies and hand it back.
+            std::size_t k = 0;
+            std::fill(touched.begin(), touched.end(), false);
+            for (std::size_t b = 0; b < batch.size(); ++b) {
+                Chunk* chunk = batch[b];
+                reply.clear();
+                for (std::size_t i = 0; i < linesPer[b]; ++i, ++k) {
+                    const Line& l = lines[k];
+                    appendReply(reply, results[k],
+                                std::string_view(captured).substr(l.bodyStart, l.bodyEnd - l.bodyStart));
+                    chunk->close |= l.quit;
+                }
+                chunk->text.swap(reply);
+                IoThread* t = chunk->conn->io;
+                t->replies.push(chunk);
+                touched[t->index] = true;
+            }
+            for (std::size_t i = 0; i < io.size(); ++i)
+                if (touched[i]) wake(io[i]->wakeFd);
+            totals.lines   += static_cast<long long>(k);
+            totals.batches += 1;
+        }
+
+        runner.replyTo(nullptr);
+        std::cout.rdbuf(saved);
+    }
+
+public:
+    FleetServer(Fleet& fleet, Route& route, ServerOptions options)
+        : fleet(fleet), route(route), options(std::move(options)) {}
+
+    ~FleetServer() { stop(); }
+
+    FleetServer(const FleetServer&) = delete;
+    FleetServer& operator=(const FleetServer&) = delete;
+
+    // ── start — bind, then spawn the owner and I/O threads ───────────────────
+    bool start(std::string* error = nullptr) {
+        if (running) return true;
+        if (options.unixPath.empty() && options.tcpPort < 0) {
+            if (error != nullptr) *error = "no Unix path or TCP port";
+            return false;
+        }
+        if (!options.unixPath.empty() && !listenUnix(error)) return false;
+        if (options.tcpPort >= 0 && !listenTcp(error)) {
+            closeListeners();
+            return false;
+        }
+        ownerWake = ::eventfd(0, EFD_CLOEXEC);
+        if (ownerWake < 0) {
+            closeListeners();
+            return fail(error, "eventfd");
+        }
+
+        unsigned threads = options.ioThreads != 0 ? options.ioThreads
+                                                  : std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i) {
+            std::unique_ptr<IoThread> t(new IoThread());
+            t->index  = i;
+            t->epfd   = ::epoll_create1(EPOLL_CLOEXEC);
+            t->wakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            epoll_event ev{};
+            ev.events   = EPOLLIN;
+            ev.data.ptr = &t->wakeFd;
+            ::epoll_ctl(t->epfd, EPOLL_CTL_ADD, t->wakeFd, &ev);
+            for (int& l : listeners) {
+                if (l < 0) continue;
+                ev.events   = EPOLLIN | EPOLLEXCLUSIVE;
+                ev.data.ptr = &l;
+                ::epoll_ctl(t->epfd, EPOLL_CTL_ADD, l, &ev);
+            }
+            io.push_back(std::move(t));
+        }
+
+        stopOwner = false;
+        stopIo    = false;
+        running   = true;
+        owner = std::thread([this] { ownerLoop(); });
+        for (auto& t : io) {
+            IoThread* raw = t.get();
+            t->thread = std::thread([this, raw] { ioLoop(*raw); });
+        }
+        return true;
+    }
+
+    // ── stop — finish the owner's work, then close every connection ──────────
+    void stop() {
+        if (!running) return;
+        running = false;
+        stopOwner.store(true, std::memory_order_release);
+        wake(ownerWake);
+        owner.join();
+        stopIo.store(true, std::memory_order_release);
+        for (auto& t : io) wake(t->wakeFd);
+        for (auto& t : io) {
+            t->thread.join();
+            totals.connections += t->accepted;
+            ::close(t->epfd);
+            ::close(t->wakeFd);
+        }
+        io.clear();
+        while (Chunk* chunk = requests.pop()) delete chunk;  // not reached by the owner
+        ::close(ownerWake);
+        ownerWake = -1;
+        closeListeners();
+    }
+
+    int tcpPort() const { return boundPort; }
+    const ServerStats& stats() const { return totals; }
+};
+
+#endif  // __linux__
+
+#endif
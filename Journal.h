@@ -0,0 +1,776 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Cargo.h"
+#include "EventSink.h"
+#include "Snapshot.h"
+
+// ── Journal file format ──────────────────────────────────────────────────────
+//
+//   header  : "TCJRNL\0\0" | u32 version | u32 reserved        (16 bytes)
+//   record  : u32 payload length | u32 FNV-1a of payload | payload
+//   payload : varint seq | u8 op | op fields
+//
+// Strings are varint length + bytes, integers zigzag varints. Sequence numbers
+// grow by one per record across the life of the journal; a snapshot remembers
+// the last one it includes, so recovery skips anything older. A record that is
+// cut short or fails its checksum marks the end of the valid journal (a torn
+// write from a crash); recovery truncates there.
+namespace journal {
+
+constexpr char          kMagic[8]   = {'T', 'C', 'J', 'R', 'N', 'L', '\0', '\0'};
+constexpr std::uint32_t kVersion    = 1;
+constexpr std::size_t   kHeaderSize = 16;
+constexpr std::size_t   kRecordHead = 8;
+
+enum class Op : std::uint8_t {
+    AddTrain = 1,     // id, name, maxWeight
+    RemoveTrain,      // id
+    LoadCargo,        // trainId, name, type, weight
+    LoadCargoBatch,   // trainId, count, (name, type, weight) * count
+    UnloadCargo,      // trainId, name
+    AddStation,       // name
+    AddStations,      // count, name * count
+    RemoveStation,    // name
+    AdvanceStation,   // (no fields)
+    AdvanceBy,        // k
+    UnloadNth,        // trainId, name, nth (a handle: nth item with that name)
+    UpdateWeight      // trainId, name, nth, weight
+};
+
+inline std::uint32_t checksum(const char* p, std::size_t n) {
+    std::uint32_t h = 2166136261u;
+    for (std::size_t i = 0; i < n; ++i) {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// ── Encoder — appends fields to a payload string ─────────────────────────────
+class Encoder {
+private:
+    std::string& out;
+
+public:
+    explicit Encoder(std::string& out) : out(out) {}
+
+    void varint(std::uint64_t v) {
+        while (v >= 0x80) {
+            out += static_cast<char>((v & 0x7F) | 0x80);
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+
+    void integer(long long v) {
+        varint((static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+    }
+
+    void op(Op o) { out += static_cast<char>(o); }
+
+    template <typename T>
+    void text(const T& value) {
+        const auto s = textOf(value);
+        varint(s.size());
+        out.append(s.data(), s.size());
+    }
+};
+
+// ── Decoder — reads fields back; ok() turns false on any overrun ─────────────
+class Decoder {
+private:
+    const char* p;
+    const char* end;
+    bool good;
+
+public:
+    Decoder(const char* p, std::size_t n) : p(p), end(p + n), good(true) {}
+
+    std::uint64_t varint() {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (p == end) break;
+            unsigned char b = static_cast<unsigned char>(*p++);
+            v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return v;
+        }
+        good = false;
+        return 0;
+    }
+
+    long long integer() {
+        std::uint64_t v = varint();
+        return static_cast<long long>((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    Op op() {
+        if (p == end) {
+            good = false;
+            return Op::AdvanceStation;
+        }
+        return static_cast<Op>(*p++);
+    }
+
+    std::string_view text() {
+        std::uint64_t n = varint();
+        if (!good || n > static_cast<std::uint64_t>(end - p)) {
+            good = false;
+            return std::string_view();
+        }
+        std::string_view s(p, static_cast<std::size_t>(n));
+        p += n;
+        return s;
+    }
+
+    bool ok() const { return good; }
+};
+
+}  // namespace journal
+
+// ── Journal — append-only operation log with group commit ────────────────────
+// append() only copies the record into an in-memory batch and returns its
+// sequence number. A background flusher thread takes whatever has piled up,
+// writes it with one write(2) and covers it with one fdatasync, so every
+// writer that arrived during the previous sync shares the next one.
+//
+// SyncMode:
+//   None  — write batches but never fsync (OS page cache only)
+//   Async — fsync every batch; callers never wait (loses at most the batch
+//           in flight on a crash)
+//   Group — fsync every batch; commit(seq) waits until seq is durable
+//
+// A failed write or fsync leaves the file in an unknown state, so it is
+// sticky: durableSeq stops where it was, later batches are dropped, and
+// append(), commit() and sync() report the failure from then on.
+//
+// Functions:
+//   open(path, mode, validBytes, nextSeq) — create or continue a journal
+//   append(payload)  — queue one encoded op, returns its sequence number
+//                      (0 once the journal has failed)
+//   commit(seq)      — in Group mode, block until seq is on disk; false if
+//                      the journal has failed
+//   lastSeq()        — the last sequence number appended
+//   sync()           — flush + fsync everything now (any mode)
+//   failed()         — a write or fsync has failed; getError() says why
+//   reset()          — empty the journal (after a compacting snapshot)
+//   getStats()       — records, bytes, syncs, largest group
+class Journal {
+public:
+    enum class SyncMode { None, Async, Group };
+
+    struct Stats {
+        std::uint64_t records  = 0;
+        std::uint64_t bytes    = 0;
+        std::uint64_t syncs    = 0;
+        std::uint64_t maxGroup = 0;  // most records covered by one sync
+    };
+
+private:
+    static constexpr std::size_t kMaxPending = 64 << 20;  // backpressure threshold
+
+    int fd;
+    SyncMode mode;
+    std::string path;
+
+    std::mutex m;
+    std::condition_variable wake;     // flusher: work arrived / stop / sync request
+    std::condition_variable durable;  // writers: durableSeq advanced
+    std::string pending;              // records not yet handed to the flusher
+    std::uint64_t pendingRecords;
+    std::uint64_t nextSeq;
+    std::uint64_t queuedSeq;          // last seq placed in pending
+    std::uint64_t durableSeq;         // last seq written (and synced unless None)
+    std::uint64_t syncRequests;       // sync() tickets handed out
+    std::uint64_t syncsDone;          // highest ticket covered by a finished fsync
+    bool stopping;
+    int  failErrno;                   // errno of the first failed write/fsync; 0 = healthy
+    Stats stats;
+    std::thread flusher;
+
+    static int syncFd(int fd) {
+#if defined(__APPLE__)
+        return ::fsync(fd);
+#else
+        return ::fdatasync(fd);
+#endif
+    }
+
+    static bool writeAll(int fd, const char* p, std::size_t n) {
+        while (n > 0) {
+            ssize_t r = ::write(fd, p, n);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            p += r;
+            n -= static_cast<std::size_t>(r);
+        }
+        return true;
+    }
+
+    void flushLoop() {
+        std::string batch;
+        std::unique_lock<std::mutex> lock(m);
+        for (;;) {
+            wake.wait(lock, [this] {
+                return stopping || syncRequests > syncsDone || !pending.empty();
+            });
+            if (pending.empty() && syncRequests == syncsDone && stopping) break;
+
+            batch.swap(pending);
+            std::uint64_t upTo    = queuedSeq;
+            std::uint64_t records = pendingRecords;
+            std::uint64_t ticket  = syncRequests;
+            bool forceSync        = ticket > syncsDone;
+            pendingRecords = 0;
+            lock.unlock();
+
+            // failErrno is only written by this thread, so reading it unlocked is safe.
+            const bool wantSync = mode != SyncMode::None || forceSync;
+            bool ok = failErrno == 0 && writeAll(fd, batch.data(), batch.size())
+                   && (!wantSync || syncFd(fd) == 0);
+            const int err = errno;
+            batch.clear();
+
+            lock.lock();
+            if (ok) durableSeq = upTo;
+            else if (failErrno == 0) failErrno = err != 0 ? err : EIO;
+            if (forceSync) syncsDone = ticket;
+            if (ok && wantSync) stats.syncs++;
+            if (records > stats.maxGroup) stats.maxGroup = records;
+            durable.notify_all();
+        }
+    }
+
+public:
+    Journal()
+        : fd(-1), mode(SyncMode::Async), pendingRecords(0), nextSeq(1), queuedSeq(0),
+          durableSeq(0), syncRequests(0), syncsDone(0), stopping(false), failErrno(0) {}
+
+    ~Journal() { close(); }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // ── open — create (with header) or continue an existing journal ──────────
+    // validBytes: length of the intact prefix found by replay; anything after
+    // it is a torn tail and is cut off. 0 starts a new journal, which is only
+    // done for a missing or empty file: replay also reports 0 for a file that
+    // is not a journal, and that is refused rather than overwritten. nextSeq
+    // continues the numbering after the last replayed record.
+    bool open(const std::string& file, SyncMode syncMode, std::uint64_t validBytes,
+              std::uint64_t firstSeq, std::string* error = nullptr) {
+        close();
+        fd = ::open(file.c_str(), O_WRONLY | O_CREAT, 0644);
+        if (fd < 0) {
+            if (error != nullptr) *error = std::string("cannot open journal: ") + std::strerror(errno);
+            return false;
+        }
+        if (validBytes < journal::kHeaderSize) {
+            struct stat st;
+            if (::fstat(fd, &st) != 0 || st.st_size != 0) {
+                if (error != nullptr) *error = "not a journal file (bad header); refusing to overwrite it";
+                ::close(fd);
+                fd = -1;
+                return false;
+            }
+            char header[journal::kHeaderSize] = {};
+            std::memcpy(header, journal::kMagic, sizeof journal::kMagic);
+            std::memcpy(header + 8, &journal::kVersion, sizeof journal::kVersion);
+            if (!writeAll(fd, header, sizeof header) || syncFd(fd) != 0) {
+                if (error != nullptr) *error = std::string("cannot write journal: ") + std::strerror(errno);
+                ::close(fd);
+                fd = -1;
+                return false;
+            }
+            validBytes = journal::kHeaderSize;
+        } else if (::ftruncate(fd, static_cast<off_t>(validBytes)) != 0) {
+            if (error != nullptr) *error = std::string("cannot truncate journal: ") + std::strerror(errno);
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        ::lseek(fd, static_cast<off_t>(validBytes), SEEK_SET);
+
+        path       = file;
+        mode       = syncMode;
+        nextSeq    = firstSeq;
+        queuedSeq  = durableSeq = firstSeq - 1;
+        stopping   = false;
+        failErrno  = 0;
+        syncRequests = syncsDone = 0;
+        stats      = Stats();
+        flusher    = std::thread(&Journal::flushLoop, this);
+        return true;
+    }
+
+    // ── close — drain, sync and stop the flusher ─────────────────────────────
+    void close() {
+        if (fd < 0) return;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+            syncRequests++;
+        }
+        wake.notify_one();
+        flusher.join();
+        ::close(fd);
+        fd = -1;
+    }
+
+    bool isOpen() const { return fd >= 0; }
+
+    // ── append — frame one payload (op + fields) and queue it ────────────────
+    // The record is framed in place at the end of the pending batch. Returns 0,
+    // queuing nothing, once the journal has failed.
+    std::uint64_t append(std::string_view payload) {
+        std::unique_lock<std::mutex> lock(m);
+        durable.wait(lock, [this] { return pending.size() < kMaxPending; });
+        if (failErrno != 0) return 0;
+
+        std::uint64_t seq = nextSeq++;
+        std::size_t start = pending.size();
+        pending.append(journal::kRecordHead, '\0');
+        journal::Encoder(pending).varint(seq);
+        pending.append(payload.data(), payload.size());
+
+        const char*   body = pending.data() + start + journal::kRecordHead;
+        std::uint32_t head[2];
+        head[0] = static_cast<std::uint32_t>(pending.size() - start - journal::kRecordHead);
+        head[1] = journal::checksum(body, head[0]);
+        std::memcpy(&pending[start], head, sizeof head);
+
+        pendingRecords++;
+        queuedSeq = seq;
+        stats.records++;
+        stats.bytes += pending.size() - start;
+        lock.unlock();
+        wake.notify_one();
+        return seq;
+    }
+
+    // ── commit — Group mode: wait until seq is durable ───────────────────────
+    // False if the journal has failed (in Group mode: before seq was durable).
+    bool commit(std::uint64_t seq) {
+        std::unique_lock<std::mutex> lock(m);
+        if (mode == SyncMode::Group)
+            durable.wait(lock, [this, seq] { return durableSeq >= seq || failErrno != 0; });
+        return failErrno == 0;
+    }
+
+    // ── sync — make everything appended so far durable, whatever the mode ────
+    bool sync() {
+        std::unique_lock<std::mutex> lock(m);
+        std::uint64_t ticket = ++syncRequests;
+        wake.notify_one();
+        durable.wait(lock, [this, ticket] { return syncsDone >= ticket; });
+        return failErrno == 0;
+    }
+
+    bool failed() {
+        std::lock_guard<std::mutex> lock(m);
+        return failErrno != 0;
+    }
+
+    std::string getError() {
+        std::lock_guard<std::mutex> lock(m);
+        return failErrno != 0 ? std::string("journal write failed: ") + std::strerror(failErrno) : std::string();
+    }
+
+    // ── reset — truncate to an empty journal; numbering continues ────────────
+    bool reset() {
+        if (!sync()) return false;
+        std::lock_guard<std::mutex> lock(m);
+        return ::ftruncate(fd, static_cast<off_t>(journal::kHeaderSize)) == 0
+            && ::lseek(fd, static_cast<off_t>(journal::kHeaderSize), SEEK_SET) >= 0
+            && syncFd(fd) == 0;
+    }
+
+    std::uint64_t lastSeq() {
+        std::lock_guard<std::mutex> lock(m);
+        return queuedSeq;
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(m);
+        return stats;
+    }
+};
+
+// ── JournalReplay — what replayJournal() found ───────────────────────────────
+struct JournalReplay {
+    std::uint64_t applied    = 0;  // records applied to the containers
+    std::uint64_t skipped    = 0;  // records already covered by the snapshot
+    std::uint64_t lastSeq    = 0;  // highest sequence number seen
+    std::uint64_t validBytes = 0;  // intact prefix length (0 = no usable journal)
+    bool          tornTail   = false;
+};
+
+// ── replayJournal — re-apply every record newer than afterSeq ────────────────
+// The file is mapped and decoded in place; ops go straight to the containers
+// with their sinks silenced. Pass the result's validBytes and lastSeq + 1 to
+// Journal::open() to keep appending after the intact prefix.
+template <typename Fleet, typename Route>
+JournalReplay replayJournal(const std::string& path, Fleet& fleet, Route& route,
+                            std::uint64_t afterSeq = 0) {
+    using T  = typename Fleet::Key;
+    using Op = journal::Op;
+
+    JournalReplay result;
+    result.lastSeq = afterSeq;
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return result;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(journal::kHeaderSize)) {
+        ::close(fd);
+        return result;
+    }
+    std::size_t length = static_cast<std::size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return result;
+    const char* base = static_cast<const char*>(mapped);
+
+    std::uint32_t version = 0;
+    std::memcpy(&version, base + 8, sizeof version);
+    if (std::memcmp(base, journal::kMagic, sizeof journal::kMagic) != 0 || version != journal::kVersion) {
+        ::munmap(mapped, length);
+        return result;
+    }
+
+    auto* fleetSink = fleet.getSink();
+    auto* routeSink = route.getSink();
+    fleet.setSink(nullptr);
+    route.setSink(nullptr);
+
+    std::vector<Cargo<T>> items;
+    std::vector<T> names;
+    std::size_t pos = journal::kHeaderSize;
+    while (pos < length) {
+        std::uint32_t head[2];
+        if (length - pos < journal::kRecordHead) break;
+        std::memcpy(head, base + pos, sizeof head);
+        const char* body = base + pos + journal::kRecordHead;
+        if (head[0] > length - pos - journal::kRecordHead
+            || journal::checksum(body, head[0]) != head[1]) break;
+
+        journal::Decoder in(body, head[0]);
+        std::uint64_t seq = in.varint();
+        Op op = in.op();
+        if (!in.ok()) break;
+        pos += journal::kRecordHead + head[0];
+        result.lastSeq = seq > result.lastSeq ? seq : result.lastSeq;
+        if (seq <= afterSeq) {
+            result.skipped++;
+            continue;
+        }
+
+        switch (op) {
+            // Fields are read into locals first: argument evaluation order is unspecified.
+            case Op::AddTrain: {
+                std::string_view id = in.text(), name = in.text();
+                fleet.emplaceTrain(id, name, static_cast<int>(in.integer()));
+                break;
+            }
+            case Op::RemoveTrain:
+                fleet.removeTrain(in.text());
+                break;
+            case Op::LoadCargo: {
+                std::string_view trainId = in.text();
+                T name(in.text()), type(in.text());
+                fleet.loadCargo(trainId, Cargo<T>(std::move(name), std::move(type),
+                                                  static_cast<int>(in.integer())));
+                break;
+            }
+            case Op::LoadCargoBatch: {
+                std::string_view trainId = in.text();
+                std::uint64_t n = in.varint();
+                items.clear();
+                for (std::uint64_t i = 0; i < n && in.ok(); ++i) {
+                    T name(in.text()), type(in.text());
+                    items.emplace_back(std::move(name), std::move(type), static_cast<int>(in.integer()));
+                }
+                fleet.loadCargoBatch(trainId, std::move(items));
+                break;
+            }
+            case Op::UnloadCargo: {
+                std::string_view trainId = in.text();
+                fleet.unloadCargo(trainId, in.text());
+                break;
+            }
+            case Op::UnloadNth: {
+                std::string_view trainId = in.text(), name = in.text();
+                int nth = static_cast<int>(in.integer());
+                fleet.unload(trainId, fleet.findCargo(trainId, name, nth));
+                break;
+            }
+            case Op::UpdateWeight: {
+                std::string_view trainId = in.text(), name = in.text();
+                int nth = static_cast<int>(in.integer());
+                int weight = static_cast<int>(in.integer());
+                fleet.updateWeight(trainId, fleet.findCargo(trainId, name, nth), weight);
+                break;
+            }
+            case Op::AddStation:
+                route.emplaceStation(in.text());
+                break;
+            case Op::AddStations: {
+                std::uint64_t n = in.varint();
+                names.clear();
+                for (std::uint64_t i = 0; i < n && in.ok(); ++i) names.emplace_back(in.text());
+                route.addStations(std::move(names));
+                break;
+            }
+            case Op::RemoveStation:
+                route.removeStation(in.text());
+                break;
+            case Op::AdvanceStation:
+                route.advanceStation();
+                break;
+            case Op::AdvanceBy:
+                route.advanceBy(in.integer());
+                break;
+        }
+        result.applied++;
+    }
+    result.validBytes = pos;
+    result.tornTail   = pos < length;
+
+    fleet.setSink(fleetSink);
+    route.setSink(routeSink);
+    ::munmap(mapped, length);
+    return result;
+}
+
+// ── JournaledFleet / JournaledRoute — log successful mutations ───────────────
+// Thin wrappers with the same mutator and display interface as TrainFleet and
+// RouteLoop (so BatchRunner and the menu can drive them unchanged). Each op is
+// encoded first (so its arguments can then be moved into the container) and
+// applied in memory; only ops that return Ok are appended, and in Group mode
+// the call returns once the record is durable. Replay is deterministic, so
+// the journal reproduces exactly the accepted ops. If the journal has failed
+// the op returns JournalFailed: it is applied in memory but will not survive
+// a restart. A null journal turns the wrapper into plain forwarding.
+//
+// Front-ends that answer many ops at once (BatchRunner) call deferCommits():
+// ops then return as soon as their record is queued, and commitPending()
+// waits once for everything appended so far, so a whole batch shares one
+// Group-mode wait. Both wrappers usually share one journal, so committing
+// either covers the other.
+template <typename Fleet>
+class JournaledFleet {
+public:
+    using Key         = typename Fleet::Key;
+    using KeyView     = typename Fleet::KeyView;
+    using CargoHandle = typename Fleet::CargoHandle;
+
+private:
+    Fleet&   fleet;
+    Journal* log;
+    bool     deferred = false;
+    std::string payload;
+
+    template <typename Encode, typename Apply>
+    OpResult record(Encode encode, Apply apply) {
+        if (log == nullptr) return apply();
+        payload.clear();
+        journal::Encoder enc(payload);
+        encode(enc);
+        OpResult r = apply();
+        if (r != OpResult::Ok) return r;
+        std::uint64_t seq = log->append(payload);
+        if (seq == 0 || (!deferred && !log->commit(seq))) return OpResult::JournalFailed;
+        return r;
+    }
+
+    // A null handle or unknown train fails in the fleet, so nothing is logged.
+    void encodeHandle(journal::Encoder& e, journal::Op op, KeyView trainId, CargoHandle item) {
+        int nth = 0;
+        const Key* name = fleet.getCargoName(trainId, item, &nth);
+        e.op(op); e.text(trainId);
+        if (name != nullptr) e.text(*name);
+        else                 e.text(std::string_view());
+        e.integer(nth);
+    }
+
+public:
+    JournaledFleet(Fleet& fleet, Journal* log) : fleet(fleet), log(log) {}
+
+    void deferCommits(bool on) { deferred = on; }
+    bool commitPending()       { return log == nullptr || log->commit(log->lastSeq()); }
+
+    OpResult addTrain(Key id, Key name, int maxWeight) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::AddTrain); e.text(id); e.text(name); e.integer(maxWeight);
+        }, [&] { return fleet.addTrain(std::move(id), std::move(name), maxWeight); });
+    }
+
+    OpResult removeTrain(KeyView id) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::RemoveTrain); e.text(id);
+        }, [&] { return fleet.removeTrain(id); });
+    }
+
+    OpResult loadCargo(KeyView trainId, Cargo<Key> cargo, CargoHandle* handle = nullptr) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::LoadCargo); e.text(trainId);
+            e.text(cargo.name); e.text(cargo.type); e.integer(cargo.weight);
+        }, [&] { return fleet.loadCargo(trainId, std::move(cargo), handle); });
+    }
+
+    template <typename... Args>
+    OpResult emplaceCargo(KeyView trainId, Args&&... args) {
+        return loadCargo(trainId, Cargo<Key>(std::forward<Args>(args)...));
+    }
+
+    OpResult loadCargoBatch(KeyView trainId, std::vector<Cargo<Key>> items) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::LoadCargoBatch); e.text(trainId); e.varint(items.size());
+            for (const Cargo<Key>& c : items) { e.text(c.name); e.text(c.type); e.integer(c.weight); }
+        }, [&] { return fleet.loadCargoBatch(trainId, std::move(items)); });
+    }
+
+    OpResult unloadCargo(KeyView trainId, KeyView cargoName) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::UnloadCargo); e.text(trainId); e.text(cargoName);
+        }, [&] { return fleet.unloadCargo(trainId, cargoName); });
+    }
+
+    // Handles do not survive a restart, so they are logged as the item's name
+    // and its position among items of that name on the train.
+    OpResult unload(KeyView trainId, CargoHandle item) {
+        return record([&](journal::Encoder& e) {
+            encodeHandle(e, journal::Op::UnloadNth, trainId, item);
+        }, [&] { return fleet.unload(trainId, item); });
+    }
+
+    OpResult updateWeight(KeyView trainId, CargoHandle item, int weight) {
+        return record([&](journal::Encoder& e) {
+            encodeHandle(e, journal::Op::UpdateWeight, trainId, item);
+            e.integer(weight);
+        }, [&] { return fleet.updateWeight(trainId, item, weight); });
+    }
+
+    CargoHandle findCargo(KeyView trainId, KeyView name, int nth = 0) {
+        return fleet.findCargo(trainId, name, nth);
+    }
+
+    int  getRemainingCapacity(KeyView trainId) { return fleet.getRemainingCapacity(trainId); }
+    void displayFleet()                        { fleet.displayFleet(); }
+    void displayTrain(KeyView id)              { fleet.displayTrain(id); }
+    template <typename Fn>
+    void forEachTrain(Fn fn) const             { fleet.forEachTrain(fn); }
+    auto findCargoByType(KeyView type) const   { return fleet.findCargoByType(type); }
+    auto findCargoByName(KeyView name) const   { return fleet.findCargoByName(name); }
+    auto findCargoByWeight(int lo, int hi) const { return fleet.findCargoByWeight(lo, hi); }
+    auto getSink() const                       { return fleet.getSink(); }
+    Fleet& base()                              { return fleet; }
+};
+
+template <typename Route>
+class JournaledRoute {
+public:
+    using Key     = typename Route::Key;
+    using KeyView = typename Route::KeyView;
+
+private:
+    Route&   route;
+    Journal* log;
+    bool     deferred = false;
+    std::string payload;
+
+    template <typename Encode, typename Apply>
+    OpResult record(Encode encode, Apply apply) {
+        if (log == nullptr) return apply();
+        payload.clear();
+        journal::Encoder enc(payload);
+        encode(enc);
+        OpResult r = apply();
+        if (r != OpResult::Ok) return r;
+        std::uint64_t seq = log->append(payload);
+        if (seq == 0 || (!deferred && !log->commit(seq))) return OpResult::JournalFailed;
+        return r;
+    }
+
+public:
+    JournaledRoute(Route& route, Journal* log) : route(route), log(log) {}
+
+    void deferCommits(bool on) { deferred = on; }
+    bool commitPending()       { return log == nullptr || log->commit(log->lastSeq()); }
+
+    OpResult addStation(Key name) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::AddStation); e.text(name);
+        }, [&] { return route.addStation(std::move(name)); });
+    }
+
+    OpResult addStations(std::vector<Key> names) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::AddStations); e.varint(names.size());
+            for (const Key& n : names) e.text(n);
+        }, [&] { return route.addStations(std::move(names)); });
+    }
+
+    OpResult removeStation(KeyView name) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::RemoveStation); e.text(name);
+        }, [&] { return route.removeStation(name); });
+    }
+
+    OpResult advanceStation() {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::AdvanceStation);
+        }, [&] { return route.advanceStation(); });
+    }
+
+    OpResult advanceBy(long long k) {
+        return record([&](journal::Encoder& e) {
+            e.op(journal::Op::AdvanceBy); e.integer(k);
+        }, [&] { return route.advanceBy(k); });
+    }
+
+    bool hasStation(KeyView name) const { return route.hasStation(name); }
+    int  getCurrentIndex() const        { return route.getCurrentIndex(); }
+    template <typename Fn>
+    void forEachStation(Fn fn) const    { route.forEachStation(fn); }
+    void displayRoute()  { route.displayRoute(); }
+    auto getSink() const { return route.getSink(); }
+    Route& base()        { return route; }
+};
+
+// ── compactJournal — fold the journal into a snapshot, then empty it ─────────
+// The snapshot records the last folded sequence number, and writeSnapshot()
+// has fsynced both the file and its directory before the journal is
+// truncated, so a crash between the two is harmless: replay skips those.
+template <typename Fleet, typename Route>
+bool compactJournal(Journal& log, const std::string& snapshotPath, const Fleet& fleet,
+                    const Route& route, std::string* error = nullptr) {
+    if (!log.sync()) {
+        if (error != nullptr) *error = log.getError();
+        return false;
+    }
+    if (!writeSnapshot(snapshotPath, fleet, route, error, log.lastSeq())) return false;
+    if (!log.reset()) {
+        if (error != nullptr) *error = std::string("cannot truncate journal: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+#endif
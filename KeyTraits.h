@@ -0,0 +1,27 @@
+#ifndef KEYTRAITS_H
+#define KEYTRAITS_H
+
+#include <string>
+#include <string_view>
+
+// ── KeyTraits — how containers accept and index keys of type T ───────────────
+//   View     — parameter type for lookups (find / remove / unload by key).
+//              For std::string it is std::string_view, so a literal, a string
+//              or a view can be passed without building a temporary string.
+//   IndexKey — key stored in hash indexes. For std::string it is a view of
+//              the id inside the node, which never moves while indexed, so
+//              the index holds no second copy of every id.
+// Any other T is taken by const reference and indexed by value.
+template <typename T>
+struct KeyTraits {
+    using View     = const T&;
+    using IndexKey = T;
+};
+
+template <>
+struct KeyTraits<std::string> {
+    using View     = std::string_view;
+    using IndexKey = std::string_view;
+};
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+
+// ── Operation metrics — counts, nodes traversed and latency per operation ────
+// Containers open a metrics::Scope at the top of each instrumented operation
+// and call visit() for every node they step over; when the scope closes it
+// records one call and its traversal length into a process-wide registry.
+// Counters are relaxed atomics, so manifests used from several threads
+// (ConcurrentFleet) are counted correctly.
+//
+// Only the outermost Scope on a thread reads the clock: a fleet load that
+// finds its train and loads its manifest is timed once, as fleet.loadCargo,
+// while fleet.find and manifest.loadCargo inside it count calls and nodes
+// only. Operations that only ever run nested show no latency.
+//
+// Latency (ns) and traversal length (nodes) each go into a log2 histogram:
+// bucket b holds values in [2^(b-1), 2^b), bucket 0 holds zero, and the last
+// bucket also takes everything larger. report() prints per-operation totals
+// with percentile upper bounds read from those buckets, which is where
+// pathological walks show up first.
+//
+// Build with -DTRAIN_CARGO_NO_METRICS to compile every Scope down to nothing.
+namespace metrics {
+
+enum class Op : std::uint8_t {
+    FleetFind,           // TrainFleet::findTrain — nodes = ids in the hash bucket
+    FleetAddTrain,
+    FleetRemoveTrain,    // nodes = manifest items folded out of the aggregates
+    FleetLoadCargo,
+    FleetLoadBatch,      // nodes = items in the batch
+    FleetUnloadCargo,
+    FleetDisplay,        // nodes = trains + cargo items printed
+    FleetPlanCargo,      // nodes = items planned (CargoPlanner.h)
+    FleetQuery,          // findCargoBy* — nodes = hits (type/name buckets)
+    FleetUpdateWeight,
+    ManifestLoad,
+    ManifestLoadBatch,   // nodes = items linked
+    ManifestUnload,      // by name (name index) or by handle; no walk
+    ManifestDisplay,
+    RouteAddStation,
+    RouteAddStations,
+    RouteRemoveStation,
+    RouteAdvance,        // advanceStation and advanceBy
+    RouteSeek,           // index/position/distance queries (rank tree lookups)
+    RouteDisplay,
+    Count
+};
+
+constexpr std::size_t kOpCount = static_cast<std::size_t>(Op::Count);
+constexpr std::size_t kBuckets = 64;
+
+inline const char* name(Op op) {
+    switch (op) {
+        case Op::FleetFind:          return "fleet.find";
+        case Op::FleetAddTrain:      return "fleet.addTrain";
+        case Op::FleetRemoveTrain:   return "fleet.removeTrain";
+        case Op::FleetLoadCargo:     return "fleet.loadCargo";
+        case Op::FleetLoadBatch:     return "fleet.loadCargoBatch";
+        case Op::FleetUnloadCargo:   return "fleet.unloadCargo";
+        case Op::FleetDisplay:       return "fleet.display";
+        case Op::FleetPlanCargo:     return "fleet.planCargo";
+        case Op::FleetQuery:         return "fleet.findCargo";
+        case Op::FleetUpdateWeight:  return "fleet.updateWeight";
+        case Op::ManifestLoad:       return "manifest.loadCargo";
+        case Op::ManifestLoadBatch:  return "manifest.loadCargoBatch";
+        case Op::ManifestUnload:     return "manifest.unloadCargo";
+        case Op::ManifestDisplay:    return "manifest.display";
+        case Op::RouteAddStation:    return "route.addStation";
+        case Op::RouteAddStations:   return "route.addStations";
+        case Op::RouteRemoveStation: return "route.removeStation";
+        case Op::RouteAdvance:       return "route.advanceStation";
+        case Op::RouteSeek:          return "route.seek";
+        case Op::RouteDisplay:       return "route.display";
+        case Op::Count:              break;
+    }
+    return "unknown";
+}
+
+// log2 bucket: 0 -> 0, 1 -> 1, 2..3 -> 2, 4..7 -> 3, ..., 2^62 and up -> 63
+inline std::size_t bucketOf(std::uint64_t v) {
+#if defined(__GNUC__)
+    std::size_t b = v == 0 ? 0 : static_cast<std::size_t>(64 - __builtin_clzll(v));
+#else
+    std::size_t b = 0;
+    while (v != 0) { ++b; v >>= 1; }
+#endif
+    return b < kBuckets ? b : kBuckets - 1;
+}
+
+// ── OpStats — plain copy of one operation's counters ─────────────────────────
+struct OpStats {
+    std::uint64_t calls    = 0;
+    std::uint64_t timed    = 0;  // calls made outermost, the ones with a latency
+    std::uint64_t totalNs  = 0;
+    std::uint64_t maxNs    = 0;
+    std::uint64_t nodes    = 0;
+    std::uint64_t maxNodes = 0;
+    std::uint64_t latency[kBuckets]   = {};
+    std::uint64_t traversal[kBuckets] = {};
+
+    // Upper bound of the bucket holding the p-th fraction of calls, capped at
+    // the observed maximum.
+    static std::uint64_t percentile(const std::uint64_t (&hist)[kBuckets],
+                                    std::uint64_t calls, std::uint64_t max, double p) {
+        std::uint64_t want = static_cast<std::uint64_t>(p * calls), seen = 0;
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            seen += hist[b];
+            if (seen > want) {
+                std::uint64_t upper = b == 0 ? 0 : (std::uint64_t(1) << b) - 1;
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+};
+
+// ── Registry — process-wide counters, one slot per Op ────────────────────────
+class Registry {
+private:
+    struct Counters {
+        std::atomic<std::uint64_t> calls{0}, timed{0}, totalNs{0}, maxNs{0}, nodes{0}, maxNodes{0};
+        std::atomic<std::uint64_t> latency[kBuckets]   = {};
+        std::atomic<std::uint64_t> traversal[kBuckets] = {};
+    };
+    Counters ops[kOpCount];
+
+    static void raise(std::atomic<std::uint64_t>& slot, std::uint64_t v) {
+        std::uint64_t cur = slot.load(std::memory_order_relaxed);
+        while (v > cur && !slot.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {}
+    }
+
+public:
+    // A call without a latency (a nested Scope).
+    void record(Op op, std::uint64_t nodes) {
+        Counters& c = ops[static_cast<std::size_t>(op)];
+        c.calls.fetch_add(1, std::memory_order_relaxed);
+        c.nodes.fetch_add(nodes, std::memory_order_relaxed);
+        c.traversal[bucketOf(nodes)].fetch_add(1, std::memory_order_relaxed);
+        raise(c.maxNodes, nodes);
+    }
+
+    void record(Op op, std::uint64_t ns, std::uint64_t nodes) {
+        record(op, nodes);
+        Counters& c = ops[static_cast<std::size_t>(op)];
+        c.timed.fetch_add(1, std::memory_order_relaxed);
+        c.totalNs.fetch_add(ns, std::memory_order_relaxed);
+        c.latency[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        raise(c.maxNs, ns);
+    }
+
+    OpStats stats(Op op) const {
+        const Counters& c = ops[static_cast<std::size_t>(op)];
+        OpStats s;
+        s.calls    = c.calls.load(std::memory_order_relaxed);
+        s.timed    = c.timed.load(std::memory_order_relaxed);
+        s.totalNs  = c.totalNs.load(std::memory_order_relaxed);
+        s.maxNs    = c.maxNs.load(std::memory_order_relaxed);
+        s.nodes    = c.nodes.load(std::memory_order_relaxed);
+        s.maxNodes = c.maxNodes.load(std::memory_order_relaxed);
+        for (std::size_t b = 0; b < kBuckets; ++b) {
+            s.latency[b]   = c.latency[b].load(std::memory_order_relaxed);
+            s.traversal[b] = c.traversal[b].load(std::memory_order_relaxed);
+        }
+        return s;
+    }
+
+    void reset() {
+        for (Counters& c : ops) {
+            c.calls = 0; c.timed = 0; c.totalNs = 0; c.maxNs = 0; c.nodes = 0; c.maxNodes = 0;
+            for (std::size_t b = 0; b < kBuckets; ++b) c.latency[b] = 0, c.traversal[b] = 0;
+        }
+    }
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// ── Scope — times one operation and counts the nodes it visits ───────────────
+#ifndef TRAIN_CARGO_NO_METRICS
+constexpr bool kEnabled = true;
+
+// Scopes open on this thread; only the outermost one is timed.
+inline unsigned& depth() {
+    static thread_local unsigned d = 0;
+    return d;
+}
+
+class Scope {
+private:
+    using Clock = std::chrono::steady_clock;
+    Op                op;
+    bool              outermost;
+    std::uint64_t     nodes;
+    Clock::time_point start;
+
+public:
+    explicit Scope(Op op) : op(op), outermost(depth()++ == 0), nodes(0) {
+        if (outermost) start = Clock::now();
+    }
+
+    ~Scope() {
+        --depth();
+        if (!outermost) {
+            registry().record(op, nodes);
+            return;
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        registry().record(op, static_cast<std::uint64_t>(ns), nodes);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    void visit(std::uint64_t n = 1) { nodes += n; }
+};
+#else
+constexpr bool kEnabled = false;
+
+class Scope {
+public:
+    explicit Scope(Op) {}
+    void visit(std::uint64_t = 1) {}
+};
+#endif
+
+// ── report — one line per operation that has been called ─────────────────────
+inline void report(std::ostream& os) {
+    if (!kEnabled) {
+        os << "[Stats] Metrics were disabled at compile time (TRAIN_CARGO_NO_METRICS).\n";
+        return;
+    }
+    char line[192];
+    std::snprintf(line, sizeof line, "%-24s %10s %10s %10s %10s %12s %9s %9s %10s\n",
+                  "operation", "calls", "mean ns", "p50 ns<=", "p99 ns<=", "max ns",
+                  "nodes/op", "p99 n<=", "max nodes");
+    os << "\n======= OPERATION STATS =======\n" << line;
+    bool any = false;
+    for (std::size_t i = 0; i < kOpCount; ++i) {
+        OpStats s = registry().stats(static_cast<Op>(i));
+        if (s.calls == 0) continue;
+        any = true;
+        char mean[16] = "-", p50[24] = "-", p99[24] = "-", max[24] = "-";
+        if (s.timed != 0) {
+            std::snprintf(mean, sizeof mean, "%.0f", static_cast<double>(s.totalNs) / s.timed);
+            std::snprintf(p50, sizeof p50, "%llu", static_cast<unsigned long long>(
+                              OpStats::percentile(s.latency, s.timed, s.maxNs, 0.50)));
+            std::snprintf(p99, sizeof p99, "%llu", static_cast<unsigned long long>(
+                              OpStats::percentile(s.latency, s.timed, s.maxNs, 0.99)));
+            std::snprintf(max, sizeof max, "%llu", static_cast<unsigned long long>(s.maxNs));
+        }
+        std::snprintf(line, sizeof line,
+                      "%-24s %10llu %10s %10s %10s %12s %9.1f %9llu %10llu\n",
+                      name(static_cast<Op>(i)),
+                      static_cast<unsigned long long>(s.calls),
+                      mean, p50, p99, max,
+                      static_cast<double>(s.nodes) / s.calls,
+                      static_cast<unsigned long long>(OpStats::percentile(s.traversal, s.calls, s.maxNodes, 0.99)),
+                      static_cast<unsigned long long>(s.maxNodes));
+        os << line;
+    }
+    if (!any) os << "  (no operations recorded yet)\n";
+    os << "===============================\n";
+}
+
+}  // namespace metrics
+
+#endif
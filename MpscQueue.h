@@ -0,0 +1,67 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+
+// ── MpscHook — link embedded in anything that travels through an MpscQueue ───
+struct MpscHook {
+    std::atomic<MpscHook*> next{nullptr};
+};
+
+// ── MpscQueue — lock-free intrusive multi-producer, single-consumer queue ────
+// Vyukov's algorithm: a push is one atomic exchange on the head plus one
+// store, never a loop, so producers do not contend beyond that exchange; the
+// consumer walks from the tail without any atomic read-modify-write except
+// when it re-inserts the stub at the end. Items are linked through their own
+// MpscHook, so nothing is allocated per push. FIFO per producer.
+//
+// Functions:
+//   push(item) — any thread; the queue does not own the item
+//   pop()      — consumer only; nullptr when empty, or when a producer is
+//                between its two steps (that producer's wake-up follows)
+//
+// T must derive from MpscHook.
+template <typename T>
+class MpscQueue {
+private:
+    alignas(64) std::atomic<MpscHook*> head;  // last pushed; producers swap it
+    alignas(64) MpscHook* tail;               // next to pop; consumer only
+    MpscHook stub;                            // keeps the list non-empty
+
+    void link(MpscHook* item) {
+        item->next.store(nullptr, std::memory_order_relaxed);
+        MpscHook* prev = head.exchange(item, std::memory_order_acq_rel);
+        prev->next.store(item, std::memory_order_release);
+    }
+
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T* item) { link(item); }
+
+    T* pop() {
+        MpscHook* t    = tail;
+        MpscHook* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {                 // skip the stub
+            if (next == nullptr) return nullptr;
+            tail = next;
+            t    = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail = next;
+            return static_cast<T*>(t);
+        }
+        if (t != head.load(std::memory_order_acquire)) return nullptr;  // push in progress
+        link(&stub);                      // t is the last item: put the stub behind it
+        next = t->next.load(std::memory_order_acquire);
+        if (next == nullptr) return nullptr;
+        tail = next;
+        return static_cast<T*>(t);
+    }
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// ── PoolStats — usage counters reported by every node allocator ──────────────
+struct PoolStats {
+    std::size_t slabs         = 0;  // slabs currently reserved
+    std::size_t slotsReserved = 0;  // node slots across all slabs
+    std::size_t slotsInUse    = 0;  // live nodes
+    std::size_t peakInUse     = 0;  // high-water mark of live nodes
+    std::size_t allocations   = 0;  // create() calls since construction
+    std::size_t recycled      = 0;  // create() calls served from the free list
+    std::size_t bytesReserved = 0;  // slab memory held by the pool
+};
+
+// ── NodePool — slab arena for one node type (one size class) ─────────────────
+// Nodes are carved out of geometrically growing slabs (16 slots, doubling up
+// to 4096). destroy() pushes the slot onto an intrusive free list, so churn
+// reuses memory instead of going back to the general-purpose heap, and nodes
+// of one container stay packed together.
+//
+// Functions:
+//   create(args...) — construct a node in a free slot
+//   destroy(node)   — run the destructor and recycle the slot
+//   releaseAll()    — drop every slab at once (bulk teardown); the caller must
+//                     already have run destructors of any live nodes
+//   stats()         — usage counters
+template <typename Node>
+class NodePool {
+private:
+    union Slot {
+        Slot* next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    static constexpr std::size_t kFirstSlab = 16;
+    static constexpr std::size_t kMaxSlab   = 4096;
+
+    std::vector<Slot*> slabs;
+    Slot*       freeList;
+    Slot*       bump;      // next never-used slot in the newest slab
+    Slot*       bumpEnd;
+    std::size_t nextSlab;  // slot count for the next slab
+    PoolStats   counters;
+
+    void grow() {
+        Slot* slab = static_cast<Slot*>(::operator new(nextSlab * sizeof(Slot)));
+        slabs.push_back(slab);
+        bump    = slab;
+        bumpEnd = slab + nextSlab;
+        counters.slabs++;
+        counters.slotsReserved += nextSlab;
+        counters.bytesReserved += nextSlab * sizeof(Slot);
+        if (nextSlab < kMaxSlab) nextSlab *= 2;
+    }
+
+public:
+    // Containers skip their per-node destroy loops when this is true.
+    static constexpr bool kBulkRelease = true;
+
+    NodePool()
+        : freeList(nullptr), bump(nullptr), bumpEnd(nullptr), nextSlab(kFirstSlab) {}
+
+    ~NodePool() { releaseAll(); }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    // A throwing constructor (a FixedKey built from over-long text, say) puts
+    // the slot back on the free list before the exception leaves.
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        Slot* slot;
+        const bool reused = freeList != nullptr;
+        if (reused) {
+            slot     = freeList;
+            freeList = freeList->next;
+        } else {
+            if (bump == bumpEnd) grow();
+            slot = bump++;
+        }
+        Node* node;
+        try {
+            node = ::new (static_cast<void*>(slot->storage)) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->next = freeList;
+            freeList   = slot;
+            throw;
+        }
+        if (reused) counters.recycled++;
+        counters.allocations++;
+        if (++counters.slotsInUse > counters.peakInUse) counters.peakInUse = counters.slotsInUse;
+        return node;
+    }
+
+    void destroy(Node* node) {
+        node->~Node();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList   = slot;
+        counters.slotsInUse--;
+    }
+
+    void releaseAll() {
+        for (Slot* slab : slabs) ::operator delete(slab);
+        slabs.clear();
+        freeList = bump = bumpEnd = nullptr;
+        nextSlab = kFirstSlab;
+        counters.slabs = counters.slotsReserved = counters.slotsInUse = 0;
+        counters.bytesReserved = 0;
+    }
+
+    PoolStats stats() const { return counters; }
+};
+
+// ── HeapAllocator — plain new/delete, same interface as NodePool ─────────────
+// Useful as a baseline when profiling the pool.
+template <typename Node>
+class HeapAllocator {
+private:
+    PoolStats counters;
+
+public:
+    static constexpr bool kBulkRelease = false;
+
+    template <typename... Args>
+    Node* create(Args&&... args) {
+        Node* node = new Node(std::forward<Args>(args)...);
+        counters.allocations++;
+        if (++counters.slotsInUse > counters.peakInUse) counters.peakInUse = counters.slotsInUse;
+        return node;
+    }
+
+    void destroy(Node* node) {
+        delete node;
+        counters.slotsInUse--;
+    }
+
+    void releaseAll() {}
+
+    PoolStats stats() const { return counters; }
+};
+
+// ── NoPool — stand-in for containers that do not allocate per node ───────────
+struct NoPool {
+    static constexpr bool kBulkRelease = true;
+    void releaseAll() {}
+    PoolStats stats() const { return PoolStats(); }
+};
+
+#endif
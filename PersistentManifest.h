@@ -0,0 +1,228 @@
+#ifndef PERSISTENTMANIFEST_H
+#define PERSISTENTMANIFEST_H
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "Cargo.h"
+#include "EventSink.h"
+#include "KeyTraits.h"
+
+template <typename T>
+class PersistentManifest;
+
+// ── ManifestVersion — one immutable, point-in-time manifest ──────────────────
+// Items sit in a persistent treap ordered by load sequence, so an in-order
+// walk is manifest order. A published version is never modified: a write
+// copies the O(log n) nodes on the path it changes and shares every other
+// node with the version before it. A reader holding a version can walk it for
+// as long as it likes; nodes are freed when the last version using them goes
+// away (shared_ptr reference counts, i.e. RCU-style reclamation).
+//
+// Read interface is the manifests' own, so forEachTrain() callers (planner,
+// simulation, snapshots) take a version wherever they took a CargoList:
+//   forEach() / displayManifest() / getTotalWeight() / getCount()
+//   getVersion() — number of writes that produced this version
+template <typename T>
+class ManifestVersion {
+private:
+    friend class PersistentManifest<T>;
+
+    struct Item {
+        Cargo<T>      cargo;
+        std::uint64_t seq;  // load sequence, the treap key
+    };
+    struct Node;
+    using ItemPtr = std::shared_ptr<const Item>;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        ItemPtr       item;      // shared by every copy of this node
+        std::uint32_t priority;  // max-heap order; a hash of seq
+        NodePtr       left;
+        NodePtr       right;
+    };
+
+    NodePtr       root;
+    int           count       = 0;
+    int           totalWeight = 0;
+    std::uint64_t version     = 0;
+
+    // splitmix64 finaliser: priorities look random but replay identically.
+    static std::uint32_t priorityOf(std::uint64_t seq) {
+        seq += 0x9E3779B97F4A7C15ull;
+        seq = (seq ^ (seq >> 30)) * 0xBF58476D1CE4E5B9ull;
+        seq = (seq ^ (seq >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<std::uint32_t>(seq ^ (seq >> 31));
+    }
+
+    static NodePtr make(const ItemPtr& item, std::uint32_t priority, NodePtr left, NodePtr right) {
+        return std::make_shared<const Node>(Node{item, priority, std::move(left), std::move(right)});
+    }
+
+    // New items always carry the largest key, so they go down the right spine
+    // until their priority wins; only that spine is copied.
+    static NodePtr append(const NodePtr& t, const ItemPtr& item, std::uint32_t priority) {
+        if (t == nullptr || priority > t->priority) return make(item, priority, t, nullptr);
+        return make(t->item, t->priority, t->left, append(t->right, item, priority));
+    }
+
+    // Every key in a precedes every key in b.
+    static NodePtr merge(const NodePtr& a, const NodePtr& b) {
+        if (a == nullptr) return b;
+        if (b == nullptr) return a;
+        if (a->priority > b->priority) return make(a->item, a->priority, a->left, merge(a->right, b));
+        return make(b->item, b->priority, merge(a, b->left), b->right);
+    }
+
+    static NodePtr erase(const NodePtr& t, std::uint64_t seq, ItemPtr& removed) {
+        if (t == nullptr) return nullptr;
+        if (seq == t->item->seq) {
+            removed = t->item;
+            return merge(t->left, t->right);
+        }
+        if (seq < t->item->seq) return make(t->item, t->priority, erase(t->left, seq, removed), t->right);
+        return make(t->item, t->priority, t->left, erase(t->right, seq, removed));
+    }
+
+public:
+    // ── forEach — manifest order, calling fn(name, type, weight) ─────────────
+    template <typename Fn>
+    void forEach(Fn fn) const {
+        std::vector<const Node*> path;
+        const Node* cur = root.get();
+        while (cur != nullptr || !path.empty()) {
+            for (; cur != nullptr; cur = cur->left.get()) path.push_back(cur);
+            cur = path.back();
+            path.pop_back();
+            const Cargo<T>& c = cur->item->cargo;
+            fn(c.name, c.type, c.weight);
+            cur = cur->right.get();
+        }
+    }
+
+    // ── displayManifest — same layout as CargoList::displayManifest() ────────
+    void displayManifest() const {
+        if (count == 0) {
+            std::cout << "    (no cargo loaded)\n";
+            return;
+        }
+        int i = 1;
+        forEach([&i](const T& name, const T& type, int weight) {
+            std::cout << "    " << i++ << ". "
+                      << name
+                      << " | Type: "   << type
+                      << " | Weight: " << weight << " tons\n";
+        });
+    }
+
+    int getTotalWeight() const        { return totalWeight; }
+    int getCount() const              { return count; }
+    std::uint64_t getVersion() const  { return version; }
+};
+
+// ── PersistentManifest — writer side of a versioned manifest ─────────────────
+// Owns the current ManifestVersion and publishes a new one per write with an
+// atomic shared_ptr store; snapshot() is an atomic load, so readers never
+// wait on the owner's lock and never see a half-applied write.
+//
+// Writers must be serialised by the owner (ConcurrentFleet holds the train's
+// mutex). A (name, seq) index on the writer side finds the earliest-loaded
+// item with a name for unloadCargo() in O(log n), the same item CargoList
+// would remove.
+//
+// Functions:
+//   snapshot()        — current version; safe from any thread
+//   loadCargo() / loadCargoBatch() / unloadCargo() / clear() — writers only
+//   getTotalWeight() / getCount() — current totals, writers only
+//
+// Each write costs O(log n) node allocations instead of CargoList's one, the
+// price of never blocking a reader.
+template <typename T>
+class PersistentManifest {
+public:
+    using Version    = ManifestVersion<T>;
+    using VersionPtr = std::shared_ptr<const Version>;
+    using KeyView    = typename KeyTraits<T>::View;
+
+private:
+    using IndexKey = typename KeyTraits<T>::IndexKey;  // views into the items' names
+    using Item     = typename Version::Item;
+
+    VersionPtr current;  // only ever replaced through publish()
+    std::set<std::pair<IndexKey, std::uint64_t>> byName;
+    std::uint64_t nextSeq;
+
+    // Start the next version from the current one (root and totals shared).
+    std::shared_ptr<Version> draft() const { return std::make_shared<Version>(*current); }
+
+    void publish(std::shared_ptr<Version> next) {
+        next->version = current->version + 1;
+        std::atomic_store(&current, VersionPtr(std::move(next)));
+    }
+
+    void append(Version& next, Cargo<T>&& cargo) {
+        const std::uint64_t seq = nextSeq++;
+        auto item = std::make_shared<const Item>(Item{std::move(cargo), seq});
+        byName.emplace(IndexKey(item->cargo.name), seq);
+        next.count++;
+        next.totalWeight += item->cargo.weight;
+        next.root = Version::append(next.root, item, Version::priorityOf(seq));
+    }
+
+public:
+    PersistentManifest() : current(std::make_shared<const Version>()), nextSeq(0) {}
+
+    PersistentManifest(const PersistentManifest&) = delete;
+    PersistentManifest& operator=(const PersistentManifest&) = delete;
+
+    VersionPtr snapshot() const { return std::atomic_load(&current); }
+
+    // The writer is the only thread that replaces `current`, so it reads it directly.
+    int getTotalWeight() const { return current->totalWeight; }
+    int getCount() const       { return current->count; }
+
+    OpResult loadCargo(Cargo<T> cargo) {
+        std::shared_ptr<Version> next = draft();
+        append(*next, std::move(cargo));
+        publish(std::move(next));
+        return OpResult::Ok;
+    }
+
+    // One version for the whole batch: readers see all of it or none.
+    OpResult loadCargoBatch(std::vector<Cargo<T>> items) {
+        if (items.empty()) return OpResult::Ok;
+        std::shared_ptr<Version> next = draft();
+        for (Cargo<T>& c : items) append(*next, std::move(c));
+        publish(std::move(next));
+        return OpResult::Ok;
+    }
+
+    // ── unloadCargo — remove the earliest-loaded item with this name ─────────
+    // Older versions still share the item, so *removed gets a copy.
+    OpResult unloadCargo(KeyView name, Cargo<T>* removed = nullptr) {
+        auto it = byName.lower_bound(std::pair<IndexKey, std::uint64_t>(IndexKey(name), 0));
+        if (it == byName.end() || !(it->first == name)) return OpResult::CargoNotFound;
+        const std::uint64_t seq = it->second;
+        byName.erase(it);
+
+        std::shared_ptr<Version> next = draft();
+        typename Version::ItemPtr item;
+        next->root = Version::erase(current->root, seq, item);
+        next->count--;
+        next->totalWeight -= item->cargo.weight;
+        if (removed != nullptr) *removed = item->cargo;
+        publish(std::move(next));
+        return OpResult::Ok;
+    }
+
+    void clear() {
+        byName.clear();
+        publish(std::make_shared<Version>());
+    }
+};
+
+#endif
@@ -1,131 +1,369 @@
 #ifndef ROUTELOOP_H
 #define ROUTELOOP_H
 
+#include <cstddef>
 #include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "EventSink.h"
+#include "FleetPolicy.h"
+#include "KeyTraits.h"
+#include "Metrics.h"
+#include "NodePool.h"
 
 // ── Circular linked node for a station ───────────────────────────────────────
 template <typename T>
 struct StationNode {
     T              name;  // e.g. "Central Depot"
     StationNode<T>* next; // always points to something (circular — never nullptr)
+    std::size_t    slot;  // position key in RouteLoop's rank tree
 
-    StationNode(T name) : name(name), next(nullptr) {}
+    StationNode(T name) : name(std::move(name)), next(nullptr), slot(0) {}
+
+    // Builds the name in place from T's constructor arguments.
+    template <typename... Args>
+    StationNode(std::in_place_t, Args&&... args)
+        : name(std::forward<Args>(args)...), next(nullptr), slot(0) {}
+};
+
+// ── RankTree — Fenwick tree of live/dead flags over append-only slots ────────
+// Slot i holds 1 while its station is on the route and 0 once removed, so
+// prefix(i) is the number of live stations before slot i and select(k) finds
+// the slot of the k-th live one. All three operations are O(log n); push()
+// appends a slot in O(log n) without rebuilding.
+class RankTree {
+private:
+    std::vector<int> tree;  // 1-based; tree[i] sums slots (i - lowbit(i), i]
+
+    static std::size_t lowbit(std::size_t i) { return i & (~i + 1); }
+
+public:
+    RankTree() : tree(1, 0) {}
+
+    std::size_t slots() const { return tree.size() - 1; }
+
+    void clear() { tree.assign(1, 0); }
+
+    // Rebuild with n live slots (every flag 1).
+    void fill(std::size_t n) {
+        tree.resize(n + 1);
+        tree[0] = 0;
+        for (std::size_t i = 1; i <= n; ++i) tree[i] = static_cast<int>(lowbit(i));
+    }
+
+    void push(int flag) {
+        const std::size_t i = tree.size();
+        int sum = flag;
+        for (std::size_t j = i - 1, stop = i - lowbit(i); j > stop; j -= lowbit(j)) sum += tree[j];
+        tree.push_back(sum);
+    }
+
+    void add(std::size_t slot, int delta) {
+        for (std::size_t i = slot + 1; i < tree.size(); i += lowbit(i)) tree[i] += delta;
+    }
+
+    // Live slots strictly before slot.
+    int prefix(std::size_t slot) const {
+        int sum = 0;
+        for (std::size_t i = slot; i > 0; i -= lowbit(i)) sum += tree[i];
+        return sum;
+    }
+
+    // Slot of the k-th live entry (0-based); k must be below the live count.
+    std::size_t select(int k) const {
+        std::size_t step = 1;
+        while (step * 2 < tree.size()) step *= 2;
+        std::size_t pos = 0;
+        for (; step > 0; step /= 2) {
+            if (pos + step < tree.size() && tree[pos + step] <= k) {
+                pos += step;
+                k -= tree[pos];
+            }
+        }
+        return pos;  // last 1-based index with prefix <= k, i.e. the 0-based slot
+    }
 };
 
 // ── RouteLoop — circular linked list of stations ──────────────────────────────
 // The last node's next always points back to head, forming a loop.
 // A "current" pointer tracks where the fleet is right now.
 //
+// Station names are unique. Alongside the circle the route keeps:
+//   tail   — the node before head, so appends never walk the loop
+//   byName — name -> node, for O(1) lookups and duplicate checks
+//   ranks  — every node gets an increasing slot when appended, so slot order
+//            is loop order from head; a RankTree over the slots turns a node
+//            into its index (and back) in O(log n). Removal marks its slot
+//            dead; slots are renumbered once dead ones outnumber live ones.
+//
 // Functions:
 //   addStation()     — insert a new station at the end of the loop
+//   emplaceStation() — same, building the name inside the node
+//   addStations()    — append many stations (all-or-nothing on duplicates)
 //   removeStation()  — unlink a station by name, re-stitch the circle
 //   advanceStation() — move current to current->next (loops automatically)
+//   advanceBy()      — move current k stations on (negative k goes back)
 //   displayRoute()   — walk the full circle once and print every station
-template <typename T>
+//   forEachStation() — visit every station once, starting at head
+//   hasStation()     — is a name on the route
+//   positionOf()     — 0-based index of a station from head (-1 if absent)
+//   distanceTo()     — stops from current forward to a station (-1 if absent)
+//   stationAt()      — name of the i-th station from head
+//   getCurrentIndex() / setCurrentIndex() — fleet position as 0-based index
+//   clear()          — drop every station (bulk slab release with NodePool)
+//   getPoolStats()   — station pool usage
+//   setSink()        — where mutation events go (console default, nullptr = silent)
+//
+// T is a plain key type or a FleetPolicy (FleetPolicy.h); station names are
+// its Name, so a route pairs with the TrainFleet built on the same T.
+//
+// Each operation is counted in Metrics.h; only display walks the loop.
+template <typename T, template <typename> class Alloc = NodePool>
 class RouteLoop {
+public:
+    using Key     = T;  // a plain key type or a FleetPolicy; stations use its Name
+    using Name    = NameOf<T>;
+    using KeyView = typename KeyTraits<Name>::View;
+
 private:
-    StationNode<T>* head;
-    StationNode<T>* current;  // where the fleet is right now
+    using IndexKey = typename KeyTraits<Name>::IndexKey;  // views into StationNode::name for strings
+
+    Alloc<StationNode<Name>> pool;
+    StationNode<Name>* head;
+    StationNode<Name>* tail;     // tail->next == head
+    StationNode<Name>* current;  // where the fleet is right now
     int size;
+    EventSink<Name>* sink;  // nullptr = silent
+
+    std::unordered_map<IndexKey, StationNode<Name>*> byName;
+    RankTree ranks;
+    std::vector<StationNode<Name>*> slots;  // slot -> node, nullptr once removed
+
+    void emit(EventKind kind, const Name* subject = nullptr) {
+        if (sink != nullptr) sink->emit(Event<Name>{kind, subject});
+    }
+
+    void emitKey(EventKind kind, KeyView key) {
+        if (sink == nullptr) return;
+        if constexpr (std::is_same<KeyView, const Name&>::value) {
+            emit(kind, &key);
+        } else {
+            const Name owned(key);
+            emit(kind, &owned);
+        }
+    }
+
+    StationNode<Name>* find(KeyView name) const {
+        auto it = byName.find(name);
+        return it == byName.end() ? nullptr : it->second;
+    }
+
+    int rankOf(const StationNode<Name>* node) const { return ranks.prefix(node->slot); }
+    StationNode<Name>* nodeAt(int i) const { return slots[ranks.select(i)]; }
+
+    // Give a freshly linked node the next slot (loop order == slot order).
+    void assignSlot(StationNode<Name>* node) {
+        node->slot = slots.size();
+        slots.push_back(node);
+        ranks.push(1);
+    }
+
+    // Renumber live nodes 0..size-1 in loop order once dead slots dominate.
+    void compactSlots() {
+        if (slots.size() <= 2 * static_cast<std::size_t>(size) + 32) return;
+        slots.clear();
+        if (head != nullptr) {
+            StationNode<Name>* cur = head;
+            do {
+                cur->slot = slots.size();
+                slots.push_back(cur);
+                cur = cur->next;
+            } while (cur != head);
+        }
+        ranks.fill(slots.size());
+    }
 
 public:
-    RouteLoop() : head(nullptr), current(nullptr), size(0) {}
+    RouteLoop() : head(nullptr), tail(nullptr), current(nullptr), size(0), sink(consoleSink<Name>()) {}
 
-    ~RouteLoop() {
-        if (head == nullptr) return;
-        // Break the circle before freeing
-        StationNode<T>* cur = head;
-        StationNode<T>* start = head;
-        do {
-            StationNode<T>* next = cur->next;
-            delete cur;
-            cur = next;
-        } while (cur != start);
+    RouteLoop(const RouteLoop&) = delete;
+    RouteLoop& operator=(const RouteLoop&) = delete;
+
+    ~RouteLoop() { clear(); }
+
+    // ── clear — free the whole circle ─────────────────────────────────────────
+    // A slab pool only needs destructors run (if any) before dropping slabs.
+    void clear() {
+        byName.clear();
+        slots.clear();
+        ranks.clear();
+        if (head != nullptr) {
+            const bool bulk = Alloc<StationNode<Name>>::kBulkRelease;
+            if (!bulk || !std::is_trivially_destructible<StationNode<Name>>::value) {
+                StationNode<Name>* cur = head;
+                do {
+                    StationNode<Name>* next = cur->next;
+                    if (bulk) cur->~StationNode<Name>();
+                    else      pool.destroy(cur);
+                    cur = next;
+                } while (cur != head);
+            }
+        }
+        if (Alloc<StationNode<Name>>::kBulkRelease) pool.releaseAll();
+        head = tail = current = nullptr;
+        size = 0;
     }
 
     // ── addStation — insert at end, keep tail->next = head ───────────────────
-    void addStation(T name) {
-        StationNode<T>* newNode = new StationNode<T>(name);
+    OpResult addStation(Name name) { return emplaceStation(std::move(name)); }
+
+    // ── emplaceStation — addStation from Name's constructor arguments ────────
+    // The node is built first so the index can key on the name inside it.
+    template <typename... Args>
+    OpResult emplaceStation(Args&&... args) {
+        metrics::Scope m(metrics::Op::RouteAddStation);
+        StationNode<Name>* newNode = pool.create(std::in_place, std::forward<Args>(args)...);
+        if (!byName.emplace(IndexKey(newNode->name), newNode).second) {
+            emit(EventKind::StationExists, &newNode->name);
+            pool.destroy(newNode);
+            return OpResult::DuplicateId;
+        }
         if (head == nullptr) {
-            head          = newNode;
+            head = tail   = newNode;
             newNode->next = head;    // points to itself — circle of one
             current       = head;
         } else {
-            // Walk to the tail (node whose next == head)
-            StationNode<T>* tail = head;
-            while (tail->next != head) tail = tail->next;
-
             tail->next    = newNode;
             newNode->next = head;    // close the circle
+            tail          = newNode;
         }
+        assignSlot(newNode);
         size++;
-        std::cout << "[Route] Station added: \"" << name << "\"\n";
+        emit(EventKind::StationAdded, &newNode->name);
+        return OpResult::Ok;
     }
 
-    // ── removeStation — unlink by name, re-stitch the circle ─────────────────
-    void removeStation(T name) {
+    // ── addStations — link a chain of stations, then close the circle once ───
+    // Names are moved into their nodes; pass an rvalue to avoid a copy. If any
+    // name is already on the route (or repeated in names) nothing is added.
+    OpResult addStations(std::vector<Name> names) {
+        if (names.empty()) return OpResult::Ok;
+        metrics::Scope m(metrics::Op::RouteAddStations);
+        StationNode<Name>* first = nullptr;
+        StationNode<Name>* last  = nullptr;
+        for (Name& name : names) {
+            StationNode<Name>* node = pool.create(std::move(name));
+            if (!byName.emplace(IndexKey(node->name), node).second) {
+                emit(EventKind::StationExists, &node->name);
+                pool.destroy(node);
+                for (StationNode<Name>* cur = first; cur != nullptr; ) {  // roll back
+                    StationNode<Name>* next = cur == last ? nullptr : cur->next;
+                    byName.erase(IndexKey(cur->name));
+                    pool.destroy(cur);
+                    cur = next;
+                }
+                return OpResult::DuplicateId;
+            }
+            if (first == nullptr) first = node;
+            else                  last->next = node;
+            last = node;
+        }
         if (head == nullptr) {
-            std::cout << "[Route] Route is empty.\n";
-            return;
+            head = current = first;
+        } else {
+            tail->next = first;
         }
-        StationNode<T>* cur  = head;
-        StationNode<T>* prev = nullptr;
-
-        // Walk the circle once looking for the name
-        do {
-            if (cur->name == name) {
-                if (size == 1) {
-                    // Only one station left — empty the route
-                    delete cur;
-                    head = current = nullptr;
-                    size = 0;
-                    std::cout << "[Route] Removed last station \"" << name << "\". Route is now empty.\n";
-                    return;
-                }
-
-                // Find tail to fix the circle if we remove head
-                StationNode<T>* tail = head;
-                while (tail->next != head) tail = tail->next;
+        last->next = head;           // close the circle
+        tail       = last;
+        size += static_cast<int>(names.size());
+        for (StationNode<Name>* cur = first; ; cur = cur->next) {
+            assignSlot(cur);
+            emit(EventKind::StationAdded, &cur->name);
+            if (cur == last) break;
+        }
+        return OpResult::Ok;
+    }
 
-                if (cur == head) {
-                    head       = head->next;
-                    tail->next = head;           // tail still closes the loop
-                } else {
-                    prev->next = cur->next;
-                }
+    // ── removeStation — unlink by name, re-stitch the circle ─────────────────
+    // The predecessor is found by rank (index - 1) rather than by walking.
+    OpResult removeStation(KeyView name) {
+        metrics::Scope m(metrics::Op::RouteRemoveStation);
+        if (head == nullptr) {
+            emit(EventKind::RouteEmpty);
+            return OpResult::RouteEmpty;
+        }
+        StationNode<Name>* cur = find(name);
+        if (cur == nullptr) {
+            emitKey(EventKind::StationNotFound, name);
+            return OpResult::StationNotFound;
+        }
+        byName.erase(IndexKey(cur->name));
 
-                if (current == cur) current = cur->next; // move current away
+        if (size == 1) {
+            // Only one station left — empty the route
+            emit(EventKind::LastStationRemoved, &cur->name);
+            pool.destroy(cur);
+            head = tail = current = nullptr;
+            size = 0;
+            slots.clear();
+            ranks.clear();
+            return OpResult::Ok;
+        }
 
-                std::cout << "[Route] Removed station \"" << name << "\"\n";
-                delete cur;
-                size--;
-                return;
-            }
-            prev = cur;
-            cur  = cur->next;
-        } while (cur != head);
+        StationNode<Name>* prev = cur == head ? tail : nodeAt(rankOf(cur) - 1);
+        prev->next = cur->next;                  // tail still closes the loop
+        if (cur == head)    head    = cur->next;
+        if (cur == tail)    tail    = prev;
+        if (current == cur) current = cur->next; // move current away
 
-        std::cout << "[Route] Station \"" << name << "\" not found.\n";
+        ranks.add(cur->slot, -1);
+        slots[cur->slot] = nullptr;
+        emit(EventKind::StationRemoved, &cur->name);
+        pool.destroy(cur);
+        size--;
+        compactSlots();
+        return OpResult::Ok;
     }
 
     // ── advanceStation — move current forward (loops automatically) ───────────
-    void advanceStation() {
+    OpResult advanceStation() {
+        metrics::Scope m(metrics::Op::RouteAdvance);
         if (current == nullptr) {
-            std::cout << "[Route] No stations on route.\n";
-            return;
+            emit(EventKind::NoStations);
+            return OpResult::RouteEmpty;
         }
         current = current->next;   // next is never nullptr in a circular list
-        std::cout << "[Route] Fleet arrived at: \"" << current->name << "\"\n";
+        emit(EventKind::FleetArrived, &current->name);
+        return OpResult::Ok;
+    }
+
+    // ── advanceBy — jump current k stations on, in O(log n) ──────────────────
+    // k wraps around the loop; negative k moves backwards.
+    OpResult advanceBy(long long k) {
+        metrics::Scope m(metrics::Op::RouteAdvance);
+        if (current == nullptr) {
+            emit(EventKind::NoStations);
+            return OpResult::RouteEmpty;
+        }
+        long long target = (rankOf(current) + k % size) % size;
+        if (target < 0) target += size;
+        current = nodeAt(static_cast<int>(target));
+        emit(EventKind::FleetArrived, &current->name);
+        return OpResult::Ok;
     }
 
     // ── displayRoute — walk the full circle once and print ───────────────────
     void displayRoute() {
+        metrics::Scope m(metrics::Op::RouteDisplay);
+        m.visit(size);
         if (head == nullptr) {
             std::cout << "[Route] No stations defined.\n";
             return;
         }
         std::cout << "\n--- Route Loop (" << size << " stations) ---\n";
-        StationNode<T>* cur = head;
+        StationNode<Name>* cur = head;
         int i = 1;
         do {
             std::cout << "  " << i++ << ". " << cur->name;
@@ -137,7 +375,65 @@ public:
         std::cout << "-----------------------------\n";
     }
 
+    // ── forEachStation — one lap from head, calling fn(name) ─────────────────
+    template <typename Fn>
+    void forEachStation(Fn fn) const {
+        if (head == nullptr) return;
+        const StationNode<Name>* cur = head;
+        do {
+            fn(cur->name);
+            cur = cur->next;
+        } while (cur != head);
+    }
+
+    bool hasStation(KeyView name) const { return byName.count(name) != 0; }
+
+    // ── positionOf — index of a station counted from head (-1 if absent) ─────
+    int positionOf(KeyView name) const {
+        metrics::Scope m(metrics::Op::RouteSeek);
+        const StationNode<Name>* node = find(name);
+        return node == nullptr ? -1 : rankOf(node);
+    }
+
+    // ── distanceTo — stops from current forward to a station ─────────────────
+    // 0 when the fleet is there already; -1 if the route is empty or the
+    // station is not on it. advanceBy(distanceTo(x)) arrives at x.
+    int distanceTo(KeyView name) const {
+        metrics::Scope m(metrics::Op::RouteSeek);
+        const StationNode<Name>* node = find(name);
+        if (node == nullptr) return -1;
+        int d = rankOf(node) - rankOf(current);
+        return d < 0 ? d + size : d;
+    }
+
+    // ── stationAt — name of the i-th station from head (nullptr if out of range)
+    const Name* stationAt(int i) const {
+        if (i < 0 || i >= size) return nullptr;
+        metrics::Scope m(metrics::Op::RouteSeek);
+        return &nodeAt(i)->name;
+    }
+
+    // ── getCurrentIndex — position of current counted from head (-1 if empty)
+    int getCurrentIndex() const {
+        if (current == nullptr) return -1;
+        metrics::Scope m(metrics::Op::RouteSeek);
+        return rankOf(current);
+    }
+
+    // ── setCurrentIndex — place the fleet at the i-th station from head ──────
+    OpResult setCurrentIndex(int i) {
+        if (head == nullptr) return OpResult::RouteEmpty;
+        if (i < 0 || i >= size) return OpResult::StationNotFound;
+        metrics::Scope m(metrics::Op::RouteSeek);
+        current = nodeAt(i);
+        return OpResult::Ok;
+    }
+
     int getSize() { return size; }
+    PoolStats getPoolStats() const { return pool.stats(); }
+
+    void setSink(EventSink<Name>* s) { sink = s; }
+    EventSink<Name>* getSink() const { return sink; }
 };
 
 #endif
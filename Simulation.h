@@ -0,0 +1,306 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "EventSink.h"
+#include "KeyTraits.h"
+
+// ── Simulation — discrete-event model of every train running the route ───────
+// RouteLoop has one "current" station for the whole fleet; the simulation
+// gives each train its own position instead. A train arriving at a station
+// unloads and loads by that station's rule, dwells, travels to the next
+// station and arrives there — one event per arrival, scheduled on a priority
+// queue ordered by (time, train).
+//
+// Trains never interact (stations have unlimited berths and supply), so the
+// trains are split into contiguous blocks, one per worker thread, each with
+// its own scheduler and its own per-station counters merged after the run.
+// Results depend only on the time horizon, not on the thread count.
+//
+// The route and fleet are copied when the simulation is built (station order,
+// train IDs, capacities and current loads); the containers are not modified.
+// Trains start spread evenly around the loop from the route's current station.
+//
+// Functions:
+//   setDefaultRule() / setRule(station, rule) — dwell, travel and tons moved;
+//                                               a rule must move time forward
+//   validRule(rule)                           — dwell, travel >= 0, sum > 0
+//   placeTrain(train, station)                — override a start position
+//   run(until, threads)                       — simulate [0, until], return RunStats
+//   stations() / trains()                     — per-station and per-train results
+//   report(os, maxTrains)                     — throughput tables
+template <typename T>
+class Simulation {
+public:
+    using KeyView = typename KeyTraits<T>::View;
+
+    // What happens when a train arrives at a station.
+    struct StationRule {
+        long long dwell      = 1;   // time spent at the platform
+        long long travel     = 10;  // time to reach the next station
+        int       unloadTons = 0;   // unloaded first, up to the train's load
+        int       loadTons   = 0;   // then loaded, up to the train's free capacity
+    };
+
+    struct StationStats {
+        T         name;
+        long long arrivals = 0;
+        long long unloaded = 0;  // tons
+        long long loaded   = 0;  // tons
+        long long dwell    = 0;  // train-time spent at the platform
+    };
+
+    struct TrainStats {
+        T         id;
+        int       maxWeight = 0;
+        int       load      = 0;  // tons on board (start value before a run)
+        int       position  = 0;  // station index: start, then the last one reached
+        long long stops     = 0;
+        long long laps      = 0;  // full circuits completed
+        long long unloaded  = 0;  // tons
+        long long loaded    = 0;  // tons
+    };
+
+    struct RunStats {
+        long long events  = 0;
+        long long until   = 0;
+        unsigned  threads = 0;
+        double    seconds = 0;
+    };
+
+private:
+    using IndexKey = typename KeyTraits<T>::IndexKey;
+
+    struct Arrival {
+        long long time;
+        int       train;
+        int       station;
+
+        bool operator>(const Arrival& o) const {
+            return time != o.time ? time > o.time : train > o.train;
+        }
+    };
+
+    std::vector<StationStats> stationStats;  // route order from head
+    std::vector<StationRule>  rules;
+    std::vector<TrainStats>   trainStats;    // fleet order
+    std::vector<int>          startPosition;
+    std::vector<int>          startLoad;
+    std::unordered_map<IndexKey, int> stationIndex;  // views into stationStats names
+    std::unordered_map<IndexKey, int> trainIndex;    // views into trainStats ids
+    RunStats last;
+
+    // Simulate trains [first, end) and add station activity to `stations`.
+    void runBlock(int first, int end, long long until, std::vector<StationStats>& stations,
+                  long long& events) {
+        const int n = static_cast<int>(stations.size());
+        std::priority_queue<Arrival, std::vector<Arrival>, std::greater<Arrival>> queue;
+        for (int t = first; t < end; ++t) queue.push(Arrival{0, t, trainStats[t].position});
+
+        long long done = 0;
+        while (!queue.empty()) {
+            Arrival a = queue.top();
+            queue.pop();
+            TrainStats&        train = trainStats[a.train];
+            StationStats&      at    = stations[a.station];
+            const StationRule& rule  = rules[a.station];
+
+            int out = std::min(rule.unloadTons, train.load);
+            train.load -= out;
+            int in = std::min(rule.loadTons, train.maxWeight - train.load);
+            if (in < 0) in = 0;
+            train.load += in;
+
+            if (a.station == startPosition[a.train] && train.stops > 0) train.laps++;
+            train.position = a.station;
+            train.stops++;
+            train.unloaded += out;
+            train.loaded   += in;
+            at.arrivals++;
+            at.unloaded += out;
+            at.loaded   += in;
+            at.dwell    += rule.dwell;
+            done++;
+
+            int next = a.station + 1 == n ? 0 : a.station + 1;
+            long long lap, when;  // an arrival past the end of time is past until
+            if (!__builtin_add_overflow(rule.dwell, rule.travel, &lap) &&
+                !__builtin_add_overflow(a.time, lap, &when) && when <= until)
+                queue.push(Arrival{when, a.train, next});
+        }
+        events = done;
+    }
+
+public:
+    // ── Simulation — copy station order and trains from the containers ───────
+    // Route needs forEachStation() and getCurrentIndex(); Fleet needs
+    // forEachTrain() (TrainFleet, ConcurrentFleet and the journaled wrappers).
+    template <typename Route, typename Fleet>
+    Simulation(const Route& route, const Fleet& fleet) {
+        route.forEachStation([this](const T& name) {
+            StationStats s;
+            s.name = name;
+            stationStats.push_back(std::move(s));
+        });
+        fleet.forEachTrain([this](const T& id, const T&, int maxWeight, const auto& manifest) {
+            TrainStats t;
+            t.id        = id;
+            t.maxWeight = maxWeight;
+            t.load      = manifest.getTotalWeight();
+            trainStats.push_back(std::move(t));
+        });
+        rules.assign(stationStats.size(), StationRule());
+        for (std::size_t i = 0; i < stationStats.size(); ++i)
+            stationIndex.emplace(IndexKey(stationStats[i].name), static_cast<int>(i));
+        for (std::size_t i = 0; i < trainStats.size(); ++i)
+            trainIndex.emplace(IndexKey(trainStats[i].id), static_cast<int>(i));
+
+        const std::size_t n = stationStats.size();
+        const std::size_t origin = route.getCurrentIndex() < 0 ? 0 : route.getCurrentIndex();
+        for (std::size_t i = 0; i < trainStats.size() && n != 0; ++i)
+            trainStats[i].position = static_cast<int>((origin + i * n / trainStats.size()) % n);
+        for (const TrainStats& t : trainStats) {
+            startPosition.push_back(t.position);
+            startLoad.push_back(t.load);
+        }
+    }
+
+    Simulation(const Simulation&) = delete;             // indexes hold views
+    Simulation& operator=(const Simulation&) = delete;  // into our own vectors
+
+    // A lap must take time, or run() would schedule arrivals forever without
+    // reaching `until`, and tonnage must not be negative, or an unload would
+    // add load past maxWeight; rules failing this are refused with
+    // InvalidArgument.
+    static bool validRule(const StationRule& rule) {
+        return rule.dwell >= 0 && rule.travel >= 0 && (rule.dwell > 0 || rule.travel > 0)
+            && rule.unloadTons >= 0 && rule.loadTons >= 0;
+    }
+
+    OpResult setDefaultRule(const StationRule& rule) {
+        if (!validRule(rule)) return OpResult::InvalidArgument;
+        std::fill(rules.begin(), rules.end(), rule);
+        return OpResult::Ok;
+    }
+
+    OpResult setRule(KeyView station, const StationRule& rule) {
+        if (!validRule(rule)) return OpResult::InvalidArgument;
+        auto it = stationIndex.find(station);
+        if (it == stationIndex.end()) return OpResult::StationNotFound;
+        rules[it->second] = rule;
+        return OpResult::Ok;
+    }
+
+    OpResult placeTrain(KeyView train, KeyView station) {
+        auto t = trainIndex.find(train);
+        if (t == trainIndex.end()) return OpResult::TrainNotFound;
+        auto s = stationIndex.find(station);
+        if (s == stationIndex.end()) return OpResult::StationNotFound;
+        startPosition[t->second] = s->second;
+        return OpResult::Ok;
+    }
+
+    // ── run — simulate every arrival at time <= until ────────────────────────
+    // Starts from the initial positions and loads each time, so runs can be
+    // repeated with other rules. threads = 0 uses the hardware concurrency.
+    RunStats run(long long until, unsigned threads = 0) {
+        for (StationStats& s : stationStats) s.arrivals = s.unloaded = s.loaded = s.dwell = 0;
+        for (std::size_t i = 0; i < trainStats.size(); ++i) {
+            TrainStats& t = trainStats[i];
+            t.position = startPosition[i];
+            t.load     = startLoad[i];
+            t.stops = t.laps = t.unloaded = t.loaded = 0;
+        }
+
+        last = RunStats();
+        last.until = until;
+        if (stationStats.empty() || trainStats.empty() || until < 0) return last;
+
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, trainStats.size()));
+        last.threads = threads;
+
+        const int trains = static_cast<int>(trainStats.size());
+        std::vector<std::vector<StationStats>> partial(threads, stationStats);
+        std::vector<long long> events(threads, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned w = 1; w < threads; ++w) {
+            int first = static_cast<int>(static_cast<long long>(trains) * w / threads);
+            int end   = static_cast<int>(static_cast<long long>(trains) * (w + 1) / threads);
+            workers.emplace_back([=, &partial, &events] {
+                runBlock(first, end, until, partial[w], events[w]);
+            });
+        }
+        runBlock(0, static_cast<int>(static_cast<long long>(trains) / threads), until, partial[0], events[0]);
+        for (std::thread& w : workers) w.join();
+        last.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (unsigned w = 0; w < threads; ++w) {
+            last.events += events[w];
+            for (std::size_t s = 0; s < stationStats.size(); ++s) {
+                stationStats[s].arrivals += partial[w][s].arrivals;
+                stationStats[s].unloaded += partial[w][s].unloaded;
+                stationStats[s].loaded   += partial[w][s].loaded;
+                stationStats[s].dwell    += partial[w][s].dwell;
+            }
+        }
+        return last;
+    }
+
+    const std::vector<StationStats>& stations() const { return stationStats; }
+    const std::vector<TrainStats>&   trains() const   { return trainStats; }
+    const RunStats&                  lastRun() const  { return last; }
+
+    // ── report — run summary, every station, then the first maxTrains trains ─
+    void report(std::ostream& os, std::size_t maxTrains = 20) const {
+        char line[192];
+        const double perSec = last.seconds > 0 ? last.events / last.seconds : 0;
+        std::snprintf(line, sizeof line,
+                      "\n======= SIMULATION (t = 0..%lld, %zu trains, %zu stations, %u threads) =======\n"
+                      "  %lld arrivals in %.3f s (%.0f events/s)\n",
+                      last.until, trainStats.size(), stationStats.size(), last.threads,
+                      last.events, last.seconds, perSec);
+        os << line;
+        const double span = last.until > 0 ? static_cast<double>(last.until) : 1.0;
+
+        std::snprintf(line, sizeof line, "  %-24s %10s %12s %12s %12s\n",
+                      "station", "arrivals", "unloaded t", "loaded t", "tons/time");
+        os << line;
+        for (const StationStats& s : stationStats) {
+            std::snprintf(line, sizeof line, "  %-24s %10lld %12lld %12lld %12.2f\n",
+                          std::string(textOf(s.name)).c_str(),
+                          s.arrivals, s.unloaded, s.loaded, (s.unloaded + s.loaded) / span);
+            os << line;
+        }
+
+        std::snprintf(line, sizeof line, "  %-24s %10s %8s %12s %12s %10s\n",
+                      "train", "stops", "laps", "unloaded t", "loaded t", "load");
+        os << line;
+        std::size_t shown = std::min(maxTrains, trainStats.size());
+        for (std::size_t i = 0; i < shown; ++i) {
+            const TrainStats& t = trainStats[i];
+            std::snprintf(line, sizeof line, "  %-24s %10lld %8lld %12lld %12lld %6d/%d\n",
+                          std::string(textOf(t.id)).c_str(), t.stops, t.laps,
+                          t.unloaded, t.loaded, t.load, t.maxWeight);
+            os << line;
+        }
+        if (shown < trainStats.size())
+            os << "  ... " << (trainStats.size() - shown) << " more trains\n";
+        os << "==========================================================\n";
+    }
+};
+
+#endif
@@ -0,0 +1,395 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Cargo.h"
+#include "EventSink.h"
+#include "FdWriter.h"
+
+// ── Snapshot file format (version 1, native byte order) ──────────────────────
+//
+//   SnapshotHeader                       fixed 96 bytes
+//   TrainRecord   [trainCount]           fleet order
+//   CargoRecord   [cargoCount]           every manifest back to back, in order
+//   StationRecord [stationCount]         route order, starting at head
+//   string bytes                         referenced by StrRef, no terminators
+//
+// Every record is fixed-size, so train i, cargo j or station k can be located
+// without reading anything before it. A reader only faults in the pages it
+// actually touches (see SnapshotView).
+namespace snapshot {
+
+constexpr char          kMagic[8]  = {'T', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::uint32_t kVersion   = 1;
+constexpr std::uint32_t kByteOrder = 0x01020304;  // reads back swapped on a foreign-endian host
+constexpr std::uint64_t kNoStation = ~std::uint64_t(0);
+
+struct StrRef {
+    std::uint64_t offset;  // from start of file
+    std::uint32_t length;
+    std::uint32_t reserved;
+};
+
+struct SnapshotHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t trainCount;
+    std::uint64_t cargoCount;
+    std::uint64_t stationCount;
+    std::uint64_t currentStation;  // index into stations, kNoStation if none
+    std::uint64_t trainOffset;
+    std::uint64_t cargoOffset;
+    std::uint64_t stationOffset;
+    std::uint64_t stringOffset;
+    std::uint64_t fileSize;
+    std::uint64_t journalSeq;      // last journal record folded in (0 = none)
+};
+
+struct TrainRecord {
+    StrRef        id;
+    StrRef        name;
+    std::int64_t  maxWeight;
+    std::uint64_t firstCargo;  // index into the cargo table
+    std::uint64_t cargoCount;
+};
+
+struct CargoRecord {
+    StrRef       name;
+    StrRef       type;
+    std::int64_t weight;
+};
+
+struct StationRecord {
+    StrRef name;
+};
+
+static_assert(sizeof(SnapshotHeader) == 96, "snapshot header layout changed");
+static_assert(sizeof(TrainRecord)    == 56, "snapshot train layout changed");
+static_assert(sizeof(CargoRecord)    == 40, "snapshot cargo layout changed");
+static_assert(sizeof(StationRecord)  == 16, "snapshot station layout changed");
+
+}  // namespace snapshot
+
+// ── writeSnapshot — dump fleet + route with large sequential writes ──────────
+// Two passes over the containers: the first streams the fixed-size records
+// (string offsets are known from running lengths), the second streams the
+// string bytes in the same order. Nothing is staged in memory beyond the
+// FdWriter buffer. The file is written next to `path` and renamed into place
+// after fsync, so a crash never leaves a half-written snapshot behind; the
+// directory is fsynced after the rename, so once this returns true the new
+// snapshot survives a power loss (compactJournal relies on that).
+// journalSeq records the last journal sequence number the state includes, so
+// recovery can skip journal records already folded into the snapshot.
+template <typename Fleet, typename Route>
+bool writeSnapshot(const std::string& path, const Fleet& fleet, const Route& route,
+                   std::string* error = nullptr, std::uint64_t journalSeq = 0) {
+    using namespace snapshot;
+    using T = typename Fleet::Key;
+
+    auto fail = [&](const char* what) {
+        if (error != nullptr) *error = std::string(what) + ": " + std::strerror(errno);
+        return false;
+    };
+
+    SnapshotHeader h;
+    std::memset(&h, 0, sizeof h);
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version        = kVersion;
+    h.byteOrder      = kByteOrder;
+    h.currentStation = kNoStation;
+    h.journalSeq     = journalSeq;
+
+    fleet.forEachTrain([&](const T&, const T&, int, const auto& cargo) {
+        h.trainCount++;
+        h.cargoCount += static_cast<std::uint64_t>(cargo.getCount());
+    });
+    route.forEachStation([&](const T&) { h.stationCount++; });
+    int current = route.getCurrentIndex();
+    if (current >= 0) h.currentStation = static_cast<std::uint64_t>(current);
+
+    h.trainOffset   = sizeof(SnapshotHeader);
+    h.cargoOffset   = h.trainOffset   + h.trainCount   * sizeof(TrainRecord);
+    h.stationOffset = h.cargoOffset   + h.cargoCount   * sizeof(CargoRecord);
+    h.stringOffset  = h.stationOffset + h.stationCount * sizeof(StationRecord);
+
+    const std::string tmpPath = path + ".tmp";
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return fail("cannot create snapshot");
+
+    FdWriter out(fd, 1 << 20);
+    std::uint64_t nextString = h.stringOffset;
+    auto ref = [&nextString](const T& value) {
+        const auto text = textOf(value);
+        StrRef r{nextString, static_cast<std::uint32_t>(text.size()), 0};
+        nextString += text.size();
+        return r;
+    };
+
+    // Pass 1 — fixed-size records
+    out.append(reinterpret_cast<const char*>(&h), sizeof h);  // fileSize patched below
+    std::uint64_t firstCargo = 0;
+    fleet.forEachTrain([&](const T& id, const T& name, int maxWeight, const auto& cargo) {
+        TrainRecord r{ref(id), ref(name), maxWeight, firstCargo,
+                      static_cast<std::uint64_t>(cargo.getCount())};
+        out.append(reinterpret_cast<const char*>(&r), sizeof r);
+        firstCargo += r.cargoCount;
+    });
+    fleet.forEachTrain([&](const T&, const T&, int, const auto& cargo) {
+        cargo.forEach([&](const T& name, const T& type, int weight) {
+            CargoRecord r{ref(name), ref(type), weight};
+            out.append(reinterpret_cast<const char*>(&r), sizeof r);
+        });
+    });
+    route.forEachStation([&](const T& name) {
+        StationRecord r{ref(name)};
+        out.append(reinterpret_cast<const char*>(&r), sizeof r);
+    });
+
+    // Pass 2 — string bytes, same order as the refs above
+    auto bytes = [&out](const T& value) { out.append(textOf(value)); };
+    fleet.forEachTrain([&](const T& id, const T& name, int, const auto&) {
+        bytes(id);
+        bytes(name);
+    });
+    fleet.forEachTrain([&](const T&, const T&, int, const auto& cargo) {
+        cargo.forEach([&](const T& name, const T& type, int) {
+            bytes(name);
+            bytes(type);
+        });
+    });
+    route.forEachStation(bytes);
+    out.flush();
+
+    h.fileSize = nextString;
+    bool ok = out.ok()
+           && ::pwrite(fd, &h, sizeof h, 0) == static_cast<ssize_t>(sizeof h)
+           && ::fsync(fd) == 0;
+    if (!ok) {
+        int saved = errno;
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        errno = saved;
+        return fail("cannot write snapshot");
+    }
+    ::close(fd);
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) return fail("cannot rename snapshot");
+
+    const std::size_t slash = path.rfind('/');
+    const std::string dir = slash == std::string::npos ? std::string(".")
+                          : slash == 0                 ? std::string("/")
+                                                       : path.substr(0, slash);
+    int dirFd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd < 0) return fail("cannot open snapshot directory");
+    ok = ::fsync(dirFd) == 0;
+    int saved = errno;
+    ::close(dirFd);
+    errno = saved;
+    if (!ok) return fail("cannot sync snapshot directory");
+    return true;
+}
+
+// ── SnapshotView — read-only, zero-copy view of a mapped snapshot ────────────
+// open() maps the file, validates the header and checks that the train table
+// partitions the cargo table (one pass over the train records); nothing else
+// is read.
+// Accessors return string_views pointing straight into the mapping, so
+// looking at one train touches only its record, its strings and its cargo.
+class SnapshotView {
+public:
+    struct TrainView {
+        std::string_view id;
+        std::string_view name;
+        long long        maxWeight;
+        std::uint64_t    firstCargo;
+        std::uint64_t    cargoCount;
+    };
+
+    struct CargoView {
+        std::string_view name;
+        std::string_view type;
+        long long        weight;
+    };
+
+private:
+    const char* base;
+    std::size_t length;
+    const snapshot::SnapshotHeader* header;
+    std::string lastError;
+
+    // Out-of-range refs (a damaged file) read as empty rather than past the end.
+    std::string_view str(const snapshot::StrRef& r) const {
+        if (r.offset > length || r.length > length - r.offset) return std::string_view();
+        return std::string_view(base + r.offset, r.length);
+    }
+
+    template <typename Record>
+    const Record& record(std::uint64_t tableOffset, std::uint64_t i) const {
+        return reinterpret_cast<const Record*>(base + tableOffset)[i];
+    }
+
+    bool reject(const char* why) {
+        lastError = why;
+        close();
+        return false;
+    }
+
+public:
+    SnapshotView() : base(nullptr), length(0), header(nullptr) {}
+    ~SnapshotView() { close(); }
+
+    SnapshotView(const SnapshotView&) = delete;
+    SnapshotView& operator=(const SnapshotView&) = delete;
+
+    // ── open — mmap and validate; false (see error()) if unusable ───────────
+    bool open(const std::string& path) {
+        using namespace snapshot;
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return reject("cannot open snapshot");
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+            ::close(fd);
+            return reject("snapshot too small");
+        }
+        length = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            length = 0;
+            return reject("cannot map snapshot");
+        }
+        base   = static_cast<const char*>(p);
+        header = reinterpret_cast<const SnapshotHeader*>(base);
+
+        const SnapshotHeader& h = *header;
+        if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0) return reject("not a snapshot file");
+        if (h.byteOrder != kByteOrder) return reject("snapshot written with another byte order");
+        if (h.version != kVersion) return reject("unsupported snapshot version");
+        if (h.trainCount   > length / sizeof(TrainRecord)      // keeps the products
+            || h.cargoCount   > length / sizeof(CargoRecord)   // below from wrapping
+            || h.stationCount > length / sizeof(StationRecord)
+            || h.fileSize != length
+            || h.trainOffset   != sizeof(SnapshotHeader)
+            || h.cargoOffset   != h.trainOffset   + h.trainCount   * sizeof(TrainRecord)
+            || h.stationOffset != h.cargoOffset   + h.cargoCount   * sizeof(CargoRecord)
+            || h.stringOffset  != h.stationOffset + h.stationCount * sizeof(StationRecord)
+            || h.stringOffset  >  length
+            || (h.currentStation != kNoStation && h.currentStation >= h.stationCount))
+            return reject("corrupt snapshot header");
+
+        // Each train's cargo must be the next run of the cargo table, and the
+        // runs must cover it exactly; restore and cargo() index by these.
+        std::uint64_t nextCargo = 0;
+        for (std::uint64_t i = 0; i < h.trainCount; ++i) {
+            const TrainRecord& t = record<TrainRecord>(h.trainOffset, i);
+            if (t.firstCargo != nextCargo || t.cargoCount > h.cargoCount - nextCargo)
+                return reject("corrupt snapshot train table");
+            nextCargo += t.cargoCount;
+        }
+        if (nextCargo != h.cargoCount) return reject("corrupt snapshot train table");
+        return true;
+    }
+
+    void close() {
+        if (base != nullptr) ::munmap(const_cast<char*>(base), length);
+        base   = nullptr;
+        header = nullptr;
+        length = 0;
+    }
+
+    bool isOpen() const { return base != nullptr; }
+    const std::string& error() const { return lastError; }
+
+    std::uint64_t trainCount() const   { return header->trainCount; }
+    std::uint64_t cargoCount() const   { return header->cargoCount; }
+    std::uint64_t stationCount() const { return header->stationCount; }
+    std::uint64_t journalSeq() const   { return header->journalSeq; }
+
+    // -1 when the route was empty
+    long long currentStation() const {
+        return header->currentStation == snapshot::kNoStation
+            ? -1 : static_cast<long long>(header->currentStation);
+    }
+
+    TrainView train(std::uint64_t i) const {
+        const auto& r = record<snapshot::TrainRecord>(header->trainOffset, i);
+        return TrainView{str(r.id), str(r.name), r.maxWeight, r.firstCargo, r.cargoCount};
+    }
+
+    // j is a global cargo index: train(i).firstCargo + k for its k-th item
+    CargoView cargo(std::uint64_t j) const {
+        const auto& r = record<snapshot::CargoRecord>(header->cargoOffset, j);
+        return CargoView{str(r.name), str(r.type), r.weight};
+    }
+
+    std::string_view station(std::uint64_t k) const {
+        return str(record<snapshot::StationRecord>(header->stationOffset, k).name);
+    }
+};
+
+// ── restoreSnapshot — materialize a view into fresh containers ───────────────
+// Clears both containers and rebuilds them silently with the bulk APIs. With
+// T = std::string_view the keys and names keep pointing into the mapping, so
+// nothing is copied (the view must then outlive the containers).
+//
+// Returns false if the containers reject any of it (a duplicate train id or
+// station, a manifest over its train's capacity, a current station past the
+// end); both containers are then left empty rather than half restored.
+template <typename Fleet, typename Route>
+bool restoreSnapshot(const SnapshotView& view, Fleet& fleet, Route& route) {
+    using T = typename Fleet::Key;
+
+    auto* fleetSink = fleet.getSink();
+    auto* routeSink = route.getSink();
+    fleet.setSink(nullptr);
+    route.setSink(nullptr);
+    fleet.clear();
+    route.clear();
+
+    bool ok = true;
+    std::vector<Cargo<T>> items;
+    for (std::uint64_t i = 0; ok && i < view.trainCount(); ++i) {
+        SnapshotView::TrainView t = view.train(i);
+        if (fleet.emplaceTrain(t.id, t.name, static_cast<int>(t.maxWeight)) != OpResult::Ok) {
+            ok = false;
+            break;
+        }
+        items.clear();
+        items.reserve(t.cargoCount);
+        for (std::uint64_t j = t.firstCargo; j < t.firstCargo + t.cargoCount; ++j) {
+            SnapshotView::CargoView c = view.cargo(j);
+            items.emplace_back(T(c.name), T(c.type), static_cast<int>(c.weight));
+        }
+        ok = fleet.loadCargoBatch(t.id, std::move(items)) == OpResult::Ok;
+    }
+
+    if (ok) {
+        std::vector<T> stations;
+        stations.reserve(view.stationCount());
+        for (std::uint64_t k = 0; k < view.stationCount(); ++k) stations.emplace_back(view.station(k));
+        ok = route.addStations(std::move(stations)) == OpResult::Ok;
+    }
+    if (ok && view.currentStation() >= 0)
+        ok = route.setCurrentIndex(static_cast<int>(view.currentStation())) == OpResult::Ok;
+
+    if (!ok) {
+        fleet.clear();
+        route.clear();
+    }
+    fleet.setSink(fleetSink);
+    route.setSink(routeSink);
+    return ok;
+}
+
+#endif
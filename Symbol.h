@@ -0,0 +1,205 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "KeyTraits.h"
+
+// ── SymbolTable — process-wide string interning ──────────────────────────────
+// Every distinct string is stored once and numbered densely from 0 (the empty
+// string). intern() takes a shared lock for strings already seen and an
+// exclusive lock only to add a new one.
+//
+// Id -> text lookups take no lock: texts live in fixed-size chunks that are
+// never moved or freed, published before their ids are handed out. A Symbol
+// passed between threads carries the usual happens-before with it, so its
+// text is always visible to the receiver.
+//
+// Functions:
+//   intern(text) — id for text, adding it on first sight
+//   find(text)   — id for text if already interned, else kAbsent (no insert)
+//   text(id)     — the interned text (valid for the life of the process;
+//                  empty for kAbsent)
+//   size()       — distinct strings interned so far
+class SymbolTable {
+private:
+    static constexpr std::uint32_t kChunkBits = 16;
+    static constexpr std::uint32_t kChunkSize = 1u << kChunkBits;
+    static constexpr std::uint32_t kMaxChunks = 4096;  // 2^28 symbols
+
+    mutable std::shared_mutex m;
+    std::unordered_map<std::string_view, std::uint32_t> ids;  // views into storage
+    std::deque<std::string> storage;                          // deque: never relocates
+    std::unique_ptr<std::atomic<std::string_view*>[]> chunks;
+    std::atomic<std::uint32_t> count;
+
+public:
+    static constexpr std::uint32_t kAbsent = ~std::uint32_t(0);  // never handed out
+
+    SymbolTable() : chunks(new std::atomic<std::string_view*>[kMaxChunks]), count(0) {
+        for (std::uint32_t i = 0; i < kMaxChunks; ++i) chunks[i].store(nullptr, std::memory_order_relaxed);
+        intern(std::string_view());  // id 0 = "" (default-constructed Symbol)
+    }
+
+    ~SymbolTable() {
+        for (std::uint32_t i = 0; i < kMaxChunks; ++i) delete[] chunks[i].load(std::memory_order_relaxed);
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    std::uint32_t intern(std::string_view s) {
+        {
+            std::shared_lock<std::shared_mutex> lock(m);
+            auto it = ids.find(s);
+            if (it != ids.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(m);
+        auto it = ids.find(s);  // another thread may have added it meanwhile
+        if (it != ids.end()) return it->second;
+
+        std::uint32_t id = count.load(std::memory_order_relaxed);
+        if ((id >> kChunkBits) >= kMaxChunks) throw std::length_error("SymbolTable full");
+        storage.emplace_back(s);
+        std::string_view text = storage.back();
+
+        std::string_view* chunk = chunks[id >> kChunkBits].load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new std::string_view[kChunkSize];
+            chunks[id >> kChunkBits].store(chunk, std::memory_order_release);
+        }
+        chunk[id & (kChunkSize - 1)] = text;
+        ids.emplace(text, id);
+        count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    std::uint32_t find(std::string_view s) const {
+        std::shared_lock<std::shared_mutex> lock(m);
+        auto it = ids.find(s);
+        return it == ids.end() ? kAbsent : it->second;
+    }
+
+    std::string_view text(std::uint32_t id) const {
+        if (id == kAbsent) return std::string_view();
+        return chunks[id >> kChunkBits].load(std::memory_order_acquire)[id & (kChunkSize - 1)];
+    }
+
+    std::size_t size() const { return count.load(std::memory_order_acquire); }
+};
+
+inline SymbolTable& symbols() {
+    static SymbolTable table;
+    return table;
+}
+
+// ── Symbol — a 4-byte handle to an interned string ───────────────────────────
+// Usable as the T of every container: implicitly constructible from
+// std::string, std::string_view and string literals, hashable, printable, and
+// viewable through textOf(). Equality compares ids only; ordering compares
+// text, so ordered containers sort the same as with std::string.
+//
+// Note that comparing against a plain string interns it first. Containers
+// take lookup keys as a SymbolView (below), which does not.
+class SymbolView;
+
+class Symbol {
+private:
+    std::uint32_t sym;
+
+    struct Raw {};
+    Symbol(std::uint32_t id, Raw) : sym(id) {}
+
+public:
+    Symbol() : sym(0) {}
+    Symbol(std::string_view s) : sym(symbols().intern(s)) {}
+    Symbol(const char* s) : Symbol(std::string_view(s)) {}
+    Symbol(const std::string& s) : Symbol(std::string_view(s)) {}
+    explicit Symbol(const SymbolView& v);  // interns the text of an absent view
+
+    // The symbol for s if it is interned, else one that equals no other.
+    static Symbol find(std::string_view s) { return Symbol(symbols().find(s), Raw{}); }
+
+    bool absent() const { return sym == SymbolTable::kAbsent; }
+
+    std::uint32_t id() const { return sym; }
+    std::string_view str() const { return symbols().text(sym); }
+    bool empty() const { return sym == 0; }
+
+    friend bool operator==(Symbol a, Symbol b) { return a.sym == b.sym; }
+    friend bool operator!=(Symbol a, Symbol b) { return a.sym != b.sym; }
+    friend bool operator<(Symbol a, Symbol b)  { return a.sym != b.sym && a.str() < b.str(); }
+    friend bool operator>(Symbol a, Symbol b)  { return b < a; }
+    friend bool operator<=(Symbol a, Symbol b) { return !(b < a); }
+    friend bool operator>=(Symbol a, Symbol b) { return !(a < b); }
+
+    friend std::ostream& operator<<(std::ostream& os, Symbol s) { return os << s.str(); }
+};
+
+// ── SymbolView — the lookup parameter type for Symbol (KeyTraits::View) ─────
+// Converts from a Symbol, or from text through Symbol::find(), so looking up
+// a name that was never stored does not add it to the process-wide table: it
+// converts to an absent Symbol that no index holds. The text is kept; only
+// building an owned Symbol from the view (explicitly, as containers do for
+// an event when a sink is listening) interns it.
+class SymbolView {
+private:
+    Symbol           sym;
+    std::string_view missing;  // the text when sym is absent, else empty
+
+public:
+    SymbolView(Symbol s) : sym(s), missing() {}
+    SymbolView(std::string_view s) : sym(Symbol::find(s)), missing(sym.absent() ? s : std::string_view()) {}
+    SymbolView(const char* s) : SymbolView(std::string_view(s)) {}
+    SymbolView(const std::string& s) : SymbolView(std::string_view(s)) {}
+
+    operator const Symbol&() const { return sym; }
+    const Symbol& symbol() const { return sym; }
+
+    std::string_view str() const { return sym.absent() ? missing : sym.str(); }
+
+    friend bool operator==(const SymbolView& a, const SymbolView& b) {
+        return a.sym == b.sym && (!a.sym.absent() || a.missing == b.missing);
+    }
+    friend bool operator!=(const SymbolView& a, const SymbolView& b) { return !(a == b); }
+
+    friend std::ostream& operator<<(std::ostream& os, const SymbolView& v) { return os << v.str(); }
+};
+
+inline Symbol::Symbol(const SymbolView& v)
+    : sym(v.symbol().absent() ? symbols().intern(v.str()) : v.symbol().id()) {}
+
+template <>
+struct KeyTraits<Symbol> {
+    using View     = const SymbolView&;
+    using IndexKey = Symbol;
+};
+
+// Picked over the generic textOf() in EventSink.h: no ostringstream, no copy.
+inline std::string_view textOf(Symbol s) { return s.str(); }
+inline std::string_view textOf(const SymbolView& v) { return v.str(); }
+
+namespace std {
+template <>
+struct hash<Symbol> {
+    std::size_t operator()(Symbol s) const noexcept { return s.id(); }
+};
+
+template <>
+struct hash<SymbolView> {
+    std::size_t operator()(const SymbolView& v) const noexcept { return v.symbol().id(); }
+};
+}  // namespace std
+
+#endif
@@ -2,127 +2,454 @@
 #define TRAINFLEET_H
 
 #include <iostream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "CargoList.h"
+#include "CargoArray.h"
+#include "CargoIndex.h"
+#include "KeyTraits.h"
+#include "Metrics.h"
+
+// ── Manifest backend — chosen at compile time ─────────────────────────────────
+// Build with -DTRAIN_CARGO_SOA_MANIFEST to give every train a contiguous
+// CargoArray instead of the linked CargoList; both share one interface.
+#ifdef TRAIN_CARGO_SOA_MANIFEST
+template <typename T, template <typename> class Alloc>
+using DefaultManifest = CargoArray<T, Alloc>;
+#else
+template <typename T, template <typename> class Alloc>
+using DefaultManifest = CargoList<T, Alloc>;
+#endif
 
 // ── Train node — one train in the fleet, contains its own CargoList ───────────
-template <typename T>
+template <typename T, typename Manifest = CargoList<T>>
 struct TrainNode {
-    T            id;       // e.g. "T-01"
-    T            name;     // e.g. "Iron Horse"
-    int          maxWeight;// max cargo weight in tons
-    CargoList<T> cargo;    // nested singly linked list of cargo items
-    TrainNode<T>* next;
-
-    TrainNode(T id, T name, int maxWeight)
-        : id(id), name(name), maxWeight(maxWeight), next(nullptr) {}
+    IdOf<T>      id;       // e.g. "T-01"
+    NameOf<T>    name;     // e.g. "Iron Horse"
+    WeightOf<T>  maxWeight;// max cargo weight in tons
+    Manifest     cargo;    // nested manifest (doubly linked list by default)
+    TrainNode*   next;
+    IndexedCargo<T, TrainNode>* indexed;  // this train's CargoIndex records
+
+    // id and name are built in place from whatever the caller forwards.
+    template <typename I, typename N>
+    TrainNode(I&& id, N&& name, WeightOf<T> maxWeight, typename Manifest::Pool* cargoPool)
+        : id(std::forward<I>(id)), name(std::forward<N>(name)), maxWeight(maxWeight),
+          cargo(cargoPool), next(nullptr), indexed(nullptr) {}
+};
+
+// ── Per-type aggregate — tonnage and item count for one cargo type ───────────
+struct TypeTotals {
+    long long weight = 0;
+    int       count  = 0;
 };
 
 // ── TrainFleet — singly linked list of trains ─────────────────────────────────
 // Each node IS a train and also OWNS a CargoList (nested linked list).
 //
+// A hash index maps each train ID to the link that points at its node (either
+// &head or &prev->next). That keeps the list singly linked while making
+// lookup, append and unlink O(1); displayFleet() still walks insertion order.
+// For string IDs the index keys are views of the ID stored in the node, and
+// every lookup takes a KeyView (std::string_view), so neither indexing nor
+// finding a train copies the ID (see KeyTraits.h).
+//
+// T is one key type for IDs, names and types (with int weights), or a
+// FleetPolicy choosing Id, Name and Weight separately (FleetPolicy.h). With a
+// FixedKey Id the index hashes and compares packed integers; events still
+// carry Names, so an ID is turned into one only when a sink is listening.
+// Capacity checks sum in long long through addWeight(), so a total that
+// overflows the Weight type is rejected as Overweight.
+//
 // Functions:
 //   addTrain()      — push a new train to the back of the fleet
+//   emplaceTrain()  — same, building ID and name inside the node
 //   removeTrain()   — unlink and delete a train by ID (also frees its cargo)
 //   loadCargo()     — find a train by ID, call its CargoList::loadCargo()
+//   emplaceCargo()  — same, from Cargo's constructor arguments
+//   loadCargoBatch()— one lookup and one capacity check for a whole batch
 //   unloadCargo()   — find a train by ID, call its CargoList::unloadCargo()
+//   unload()        — remove the item a CargoHandle refers to
+//   updateWeight()  — reweigh an item in place (capacity checked)
+//   findCargo()     — CargoHandle to the nth item with a name on one train
 //   displayFleet()  — traverse fleet, print each train + its manifest
 //   displayTrain()  — print one train's details and full cargo manifest
-template <typename T>
+//   forEachTrain()  — visit every train and its manifest in fleet order
+//
+// Aggregates (total tonnage, capacity, per-type tonnage) are kept current by
+// every load, unload, reweigh and removeTrain, so capacity checks and
+// summaries never rescan a manifest.
+//
+// Queries:
+//   getTotalWeight() / getTotalCapacity() / getCargoCount() — fleet-wide
+//   getRemainingCapacity(id) — free tons on one train (-1 if not found)
+//   getTypeWeight(type) / getTypeTotals() — tonnage per cargo type
+//
+// A CargoIndex (CargoIndex.h) is maintained alongside, so these return
+// (train, cargo) handles without scanning any manifest:
+//   findCargoByType(type)          — every item of a type
+//   findCargoByName(name)          — which trains hold an item of that name
+//   findCargoByWeight(min, max)    — items in a weight range, lightest first
+//
+// Train nodes and cargo nodes come from two Alloc pools owned by the fleet
+// (every manifest shares the cargo pool), so clear() and the destructor can
+// drop whole slabs instead of freeing node by node.
+//   clear()                                 — bulk teardown, fleet reusable
+//   getTrainPoolStats() / getCargoPoolStats() — pool usage
+//
+// Mutations return an OpResult and report through an EventSink (console by
+// default); setSink(nullptr) silences the fleet and every manifest in it.
+// Operations and ID lookups are counted in Metrics.h.
+template <typename T, template <typename> class Alloc = NodePool,
+          typename Manifest = DefaultManifest<T, Alloc>>
 class TrainFleet {
+public:
+    using Key      = T;  // the key type or FleetPolicy the fleet was built on
+    using Id       = IdOf<T>;
+    using Name     = NameOf<T>;
+    using Weight   = WeightOf<T>;
+    using IdView   = typename KeyTraits<Id>::View;
+    using NameView = typename KeyTraits<Name>::View;
+    using KeyView  = IdView;  // for a plain T, IdView and NameView are this type
+
+    // Stable reference to one item on one train, from loadCargo() or
+    // findCargo(); valid until that item is unloaded or its train removed.
+    // It is tagged with its train's manifest, so using it with another train
+    // is refused instead of corrupting both.
+    using CargoHandle = typename Manifest::Handle;
+
 private:
-    TrainNode<T>* head;
+    using Node      = TrainNode<T, Manifest>;
+    using CargoPool = typename Manifest::Pool;
+    using IndexKey  = typename KeyTraits<Id>::IndexKey;
+
+    Alloc<Node> trainPool;
+    CargoPool   cargoPool;  // shared by every train's CargoList
+
+    Node*  head;
+    Node** tailLink;  // where the next train gets linked (&head or &last->next)
+    std::unordered_map<IndexKey, Node**> index;  // id -> link pointing at the node
     int size;
 
-    // Internal helper — find a train node by ID
-    TrainNode<T>* findTrain(T id) {
-        TrainNode<T>* cur = head;
-        while (cur != nullptr) {
-            if (cur->id == id) return cur;
-            cur = cur->next;
+    long long totalWeight;    // sum of every manifest's weight
+    long long totalCapacity;  // sum of every train's maxWeight
+    long long cargoCount;     // cargo items across the fleet
+    std::unordered_map<Name, TypeTotals> typeTotals;
+    CargoIndex<T, Node, Alloc> cargoIndex;  // each item's record is its manifest link
+    using IndexRecord = typename CargoIndex<T, Node, Alloc>::Record;
+
+    // Fleet-wide sums go through addWeight()/subWeight() and saturate rather
+    // than wrap if they ever leave long long.
+    void addToTotals(const Name& type, Weight weight) {
+        addWeight<long long>(totalWeight, weight, totalWeight);
+        cargoCount++;
+        TypeTotals& t = typeTotals[type];
+        addWeight<long long>(t.weight, weight, t.weight);
+        t.count++;
+    }
+
+    void removeFromTotals(const Name& type, Weight weight) {
+        subWeight<long long>(totalWeight, weight, totalWeight);
+        cargoCount--;
+        auto it = typeTotals.find(type);
+        if (it == typeTotals.end()) return;
+        subWeight<long long>(it->second.weight, weight, it->second.weight);
+        if (--it->second.count == 0) typeTotals.erase(it);
+    }
+
+    EventSink<Name>* sink;  // nullptr = silent
+
+    void emit(EventKind kind, const Name* subject, const Name* detail = nullptr,
+              long long value = 0, long long limit = 0) {
+        if (sink != nullptr) sink->emit(Event<Name>{kind, subject, detail, nullptr, value, limit});
+    }
+
+    // Events carry const Name*; an ID, or a key passed as a view, is only
+    // turned into a Name when somebody is listening.
+    template <typename K>
+    void emitKey(EventKind kind, const K& key, const Name* detail = nullptr,
+                 long long value = 0, long long limit = 0) {
+        if (sink == nullptr) return;
+        if constexpr (std::is_same<K, Name>::value) {
+            emit(kind, &key, detail, value, limit);
+        } else if constexpr (std::is_constructible<Name, const K&>::value) {
+            const Name owned(key);
+            emit(kind, &owned, detail, value, limit);
+        } else {
+            const Name owned(textOf(key));
+            emit(kind, &owned, detail, value, limit);
+        }
+    }
+
+    // Count a just-loaded item in the aggregates and the CargoIndex.
+    void indexLoaded(Node* train, CargoHandle item) {
+        const Name& type   = train->cargo.typeOf(item);
+        const Weight weight = train->cargo.weightOf(item);
+        addToTotals(type, weight);
+        train->cargo.setLink(item, cargoIndex.add(train, train->cargo.nameOf(item), type, weight));
+    }
+
+    // Unload one item and drop it from the aggregates and the CargoIndex.
+    OpResult unloadItem(Node* train, CargoHandle item) {
+        IndexRecord* record = static_cast<IndexRecord*>(train->cargo.linkOf(item));
+        Cargo<T> removed;
+        OpResult r = train->cargo.unload(item, &removed);
+        if (r == OpResult::Ok) {
+            removeFromTotals(removed.type, removed.weight);
+            cargoIndex.remove(record);
         }
-        return nullptr;
+        return r;
+    }
+
+    // Internal helper — find a train node by ID via the hash index
+    Node* findTrain(IdView id) {
+        metrics::Scope m(metrics::Op::FleetFind);
+        if (metrics::kEnabled && index.bucket_count() != 0)
+            m.visit(index.bucket_size(index.bucket(id)));  // hash-chain length
+        auto it = index.find(id);
+        return it == index.end() ? nullptr : *it->second;
     }
 
 public:
-    TrainFleet() : head(nullptr), size(0) {}
+    TrainFleet()
+        : head(nullptr), tailLink(&head), size(0),
+          totalWeight(0), totalCapacity(0), cargoCount(0), sink(consoleSink<Name>()) {}
 
-    ~TrainFleet() {
-        TrainNode<T>* cur = head;
+    TrainFleet(const TrainFleet&) = delete;             // index holds addresses
+    TrainFleet& operator=(const TrainFleet&) = delete;  // of our own links
+
+    ~TrainFleet() { clear(); }
+
+    // ── clear — tear down every train and manifest ───────────────────────────
+    // With a slab pool, manifests only run element destructors and both pools
+    // drop their slabs in one go; otherwise each node goes back individually.
+    void clear() {
+        Node* cur = head;
         while (cur) {
-            TrainNode<T>* next = cur->next;
-            delete cur;             // CargoList destructor runs automatically
+            Node* next = cur->next;
+            if (Alloc<Node>::kBulkRelease) {
+                cur->cargo.releaseNodes();
+                cur->~Node();
+            } else {
+                trainPool.destroy(cur);   // CargoList destructor runs automatically
+            }
             cur = next;
         }
+        cargoIndex.clear();
+        if (Alloc<Node>::kBulkRelease) {
+            trainPool.releaseAll();
+            cargoPool.releaseAll();
+        }
+        head = nullptr;
+        tailLink = &head;
+        index.clear();
+        typeTotals.clear();
+        size = 0;
+        totalWeight = totalCapacity = cargoCount = 0;
     }
 
     // ── addTrain — push new train to back ────────────────────────────────────
-    void addTrain(T id, T name, int maxWeight) {
-        TrainNode<T>* newNode = new TrainNode<T>(id, name, maxWeight);
-        if (head == nullptr) {
-            head = newNode;
-        } else {
-            TrainNode<T>* cur = head;
-            while (cur->next != nullptr) cur = cur->next;  // walk to tail
-            cur->next = newNode;
+    // Links through tailLink, so no walk to the tail. IDs must be unique.
+    OpResult addTrain(Id id, Name name, Weight maxWeight) {
+        return emplaceTrain(std::move(id), std::move(name), maxWeight);
+    }
+
+    // ── emplaceTrain — addTrain with ID and name built inside the node ───────
+    // The node is created first and indexed by its own ID in one probe; a
+    // duplicate gives the node straight back to the pool. If building the ID
+    // throws (a FixedKey from over-long text), the pool takes its slot back
+    // and the fleet is unchanged.
+    template <typename I, typename N>
+    OpResult emplaceTrain(I&& id, N&& name, Weight maxWeight) {
+        metrics::Scope m(metrics::Op::FleetAddTrain);
+        Node* newNode = trainPool.create(std::forward<I>(id), std::forward<N>(name), maxWeight, &cargoPool);
+        if (!index.emplace(IndexKey(newNode->id), tailLink).second) {
+            emitKey(EventKind::TrainExists, newNode->id);
+            trainPool.destroy(newNode);
+            return OpResult::DuplicateId;
         }
+        newNode->cargo.setSink(sink);
+        *tailLink = newNode;
+        tailLink = &newNode->next;
         size++;
-        std::cout << "[Fleet] Train added: [" << id << "] "
-                  << name << " (max " << maxWeight << " tons)\n";
+        addWeight<long long>(totalCapacity, maxWeight, totalCapacity);
+        emitKey(EventKind::TrainAdded, newNode->id, &newNode->name, maxWeight);
+        return OpResult::Ok;
     }
 
     // ── removeTrain — unlink by ID ────────────────────────────────────────────
-    void removeTrain(T id) {
-        TrainNode<T>* cur  = head;
-        TrainNode<T>* prev = nullptr;
-
-        while (cur != nullptr) {
-            if (cur->id == id) {
-                if (prev == nullptr) head = cur->next;
-                else                 prev->next = cur->next;
-
-                std::cout << "[Fleet] Train removed: [" << id << "] " << cur->name << "\n";
-                delete cur;   // also frees nested CargoList
-                size--;
-                return;
-            }
-            prev = cur;
-            cur  = cur->next;
+    // The index gives us the link pointing at the node, so unlinking is O(1);
+    // the successor inherits that link as its own index entry.
+    OpResult removeTrain(IdView id) {
+        metrics::Scope m(metrics::Op::FleetRemoveTrain);
+        auto it = index.find(id);
+        if (it == index.end()) {
+            emitKey(EventKind::TrainIdNotFound, id);
+            return OpResult::TrainNotFound;
         }
-        std::cout << "[Fleet] Train ID \"" << id << "\" not found.\n";
+        Node** link = it->second;
+        Node*  cur  = *link;
+        index.erase(it);
+
+        *link = cur->next;
+        if (cur->next != nullptr) index[IndexKey(cur->next->id)] = link;
+        else                      tailLink = link;      // removed the tail
+
+        subWeight<long long>(totalCapacity, cur->maxWeight, totalCapacity);
+        m.visit(cur->cargo.getCount());
+        cur->cargo.forEach([this](const Name&, const Name& type, Weight weight) {
+            removeFromTotals(type, weight);
+        });
+        cargoIndex.removeTrain(cur);
+
+        emitKey(EventKind::TrainRemoved, cur->id, &cur->name);
+        trainPool.destroy(cur);   // also frees nested CargoList
+        size--;
+        return OpResult::Ok;
     }
 
     // ── loadCargo — find train, delegate to its CargoList ────────────────────
-    void loadCargo(T trainId, Cargo<T> cargo) {
-        TrainNode<T>* train = findTrain(trainId);
+    // The item is moved all the way into the manifest; its CargoHandle goes to
+    // *handle when given. Aggregates and the CargoIndex follow the manifest:
+    // they are only updated once it has accepted the item.
+    OpResult loadCargo(IdView trainId, Cargo<T> cargo, CargoHandle* handle = nullptr) {
+        metrics::Scope m(metrics::Op::FleetLoadCargo);
+        Node* train = findTrain(trainId);
         if (train == nullptr) {
-            std::cout << "[Fleet] Train \"" << trainId << "\" not found.\n";
-            return;
+            emitKey(EventKind::TrainNotFound, trainId);
+            return OpResult::TrainNotFound;
         }
-        int newTotal = train->cargo.getTotalWeight() + cargo.weight;
-        if (newTotal > train->maxWeight) {
-            std::cout << "  [Overweight] Cannot load \"" << cargo.name
-                      << "\". Would exceed max weight ("
-                      << newTotal << "/" << train->maxWeight << " tons).\n";
-            return;
+        long long newTotal;
+        if (!addWeight<long long>(train->cargo.getTotalWeight(), cargo.weight, newTotal) ||
+            newTotal > train->maxWeight) {
+            emitKey(EventKind::Overweight, train->id, &cargo.name, newTotal, train->maxWeight);
+            return OpResult::Overweight;
         }
-        std::cout << "[Train " << trainId << "] Loading cargo:\n";
-        train->cargo.loadCargo(cargo);
+        emitKey(EventKind::TrainLoading, train->id);
+        CargoHandle item;
+        OpResult r = train->cargo.loadCargo(std::move(cargo), &item);
+        if (r != OpResult::Ok) return r;
+        indexLoaded(train, item);
+        if (handle != nullptr) *handle = item;
+        return r;
+    }
+
+    // ── emplaceCargo — loadCargo from Cargo's constructor arguments ──────────
+    template <typename... Args>
+    OpResult emplaceCargo(IdView trainId, Args&&... args) {
+        return loadCargo(trainId, Cargo<T>(std::forward<Args>(args)...));
     }
 
-    // ── unloadCargo — find train, delegate to its CargoList ──────────────────
-    void unloadCargo(T trainId, T cargoName) {
-        TrainNode<T>* train = findTrain(trainId);
+    // ── loadCargoBatch — all-or-nothing load of many items onto one train ────
+    // The batch is rejected as a whole if it would exceed maxWeight.
+    OpResult loadCargoBatch(IdView trainId, std::vector<Cargo<T>> items) {
+        metrics::Scope m(metrics::Op::FleetLoadBatch);
+        m.visit(items.size());
+        Node* train = findTrain(trainId);
         if (train == nullptr) {
-            std::cout << "[Fleet] Train \"" << trainId << "\" not found.\n";
-            return;
+            emitKey(EventKind::TrainNotFound, trainId);
+            return OpResult::TrainNotFound;
+        }
+        long long newTotal = train->cargo.getTotalWeight();
+        bool fits = true;
+        for (const Cargo<T>& c : items) fits = addWeight<long long>(newTotal, c.weight, newTotal) && fits;
+        if (!fits || newTotal > train->maxWeight) {
+            emitKey(EventKind::BatchOverweight, train->id, nullptr, newTotal, train->maxWeight);
+            return OpResult::Overweight;
         }
-        std::cout << "[Train " << trainId << "] Unloading cargo:\n";
-        train->cargo.unloadCargo(cargoName);
+        emitKey(EventKind::TrainLoading, train->id);
+        std::vector<CargoHandle> loaded;
+        loaded.reserve(items.size());
+        OpResult r = train->cargo.loadCargoBatch(std::move(items), &loaded);
+        if (r != OpResult::Ok) return r;
+        for (CargoHandle item : loaded) indexLoaded(train, item);
+        return r;
+    }
+
+    // ── unloadCargo — remove the earliest-loaded item with this name ─────────
+    // The manifest's name index gives the item's handle; from there it is
+    // unload() without the handle check.
+    OpResult unloadCargo(IdView trainId, NameView cargoName) {
+        metrics::Scope m(metrics::Op::FleetUnloadCargo);
+        Node* train = findTrain(trainId);
+        if (train == nullptr) {
+            emitKey(EventKind::TrainNotFound, trainId);
+            return OpResult::TrainNotFound;
+        }
+        emitKey(EventKind::TrainUnloading, train->id);
+        CargoHandle item = train->cargo.find(cargoName);
+        if (!item) return train->cargo.unloadCargo(cargoName);  // reports the miss
+        return unloadItem(train, item);
+    }
+
+    // ── unload — remove the item a handle refers to ──────────────────────────
+    // O(1) in the manifest; the item's CargoIndex record is reached through
+    // its manifest link, so dropping it is O(1) as well (plus the byWeight
+    // erase). A handle issued by another train's manifest is CargoNotFound.
+    OpResult unload(IdView trainId, CargoHandle item) {
+        metrics::Scope m(metrics::Op::FleetUnloadCargo);
+        Node* train = findTrain(trainId);
+        if (train == nullptr) {
+            emitKey(EventKind::TrainNotFound, trainId);
+            return OpResult::TrainNotFound;
+        }
+        if (!train->cargo.owns(item)) return OpResult::CargoNotFound;
+        emitKey(EventKind::TrainUnloading, train->id);
+        return unloadItem(train, item);
+    }
+
+    // ── updateWeight — reweigh one item, keeping it in its place ─────────────
+    // Rejected with Overweight if the train's new total would exceed maxWeight,
+    // and with CargoNotFound for a handle issued by another train.
+    OpResult updateWeight(IdView trainId, CargoHandle item, Weight weight) {
+        metrics::Scope m(metrics::Op::FleetUpdateWeight);
+        Node* train = findTrain(trainId);
+        if (train == nullptr) {
+            emitKey(EventKind::TrainNotFound, trainId);
+            return OpResult::TrainNotFound;
+        }
+        if (!train->cargo.owns(item)) return OpResult::CargoNotFound;
+        const Weight oldWeight = train->cargo.weightOf(item);
+        const Name&  name      = train->cargo.nameOf(item);
+        const Name&  type      = train->cargo.typeOf(item);
+        long long delta, newTotal;
+        bool fits = subWeight<long long>(weight, oldWeight, delta);
+        fits = addWeight<long long>(train->cargo.getTotalWeight(), delta, newTotal) && fits;
+        if (!fits || newTotal > train->maxWeight) {
+            emitKey(EventKind::Overweight, train->id, &name, newTotal, train->maxWeight);
+            return OpResult::Overweight;
+        }
+        OpResult r = train->cargo.updateWeight(item, weight);
+        if (r != OpResult::Ok) return r;
+        addWeight<long long>(totalWeight, delta, totalWeight);
+        TypeTotals& t = typeTotals[type];
+        addWeight<long long>(t.weight, delta, t.weight);
+        cargoIndex.reweigh(static_cast<IndexRecord*>(train->cargo.linkOf(item)), weight);
+        return r;
+    }
+
+    // ── findCargo — handle to the nth item (0 = earliest) named `name` ───────
+    // Null if the train or item does not exist.
+    CargoHandle findCargo(IdView trainId, NameView name, int nth = 0) {
+        Node* train = findTrain(trainId);
+        return train == nullptr ? CargoHandle() : train->cargo.find(name, nth);
+    }
+
+    // ── getCargoName — name of a handle's item, and its findCargo() nth ──────
+    // Lets a journal record a handle as (name, nth), which replays exactly.
+    // nullptr if the train does not exist or the handle is not one of its items.
+    const Name* getCargoName(IdView trainId, CargoHandle item, int* nth = nullptr) {
+        Node* train = findTrain(trainId);
+        if (train == nullptr || !train->cargo.owns(item)) return nullptr;
+        if (nth != nullptr) *nth = train->cargo.ordinalOf(item);
+        return &train->cargo.nameOf(item);
     }
 
     // ── displayTrain — show one train + its full manifest ────────────────────
-    void displayTrain(T id) {
-        TrainNode<T>* train = findTrain(id);
+    void displayTrain(IdView id) {
+        Node* train = findTrain(id);
         if (train == nullptr) {
             std::cout << "[Fleet] Train \"" << id << "\" not found.\n";
             return;
@@ -137,12 +464,14 @@ public:
 
     // ── displayFleet — traverse all trains, print each with manifest ──────────
     void displayFleet() {
+        metrics::Scope m(metrics::Op::FleetDisplay);
+        m.visit(size + cargoCount);
         if (head == nullptr) {
             std::cout << "[Fleet] No trains in fleet.\n";
             return;
         }
         std::cout << "\n======= TRAIN FLEET (" << size << " trains) =======\n";
-        TrainNode<T>* cur = head;
+        Node* cur = head;
         int i = 1;
         while (cur != nullptr) {
             std::cout << "\n  #" << i++ << " [" << cur->id << "] " << cur->name
@@ -153,10 +482,70 @@ public:
             cur->cargo.displayManifest();
             cur = cur->next;
         }
+        std::cout << "\n  Fleet load: " << totalWeight << "/" << totalCapacity
+                  << " tons | " << cargoCount << " cargo items\n";
         std::cout << "=====================================\n";
     }
 
     int getSize() { return size; }
+
+    // ── Aggregate queries — O(1) except the per-train/per-type hash lookups ──
+    long long getTotalWeight() const   { return totalWeight; }
+    long long getTotalCapacity() const { return totalCapacity; }
+    long long getCargoCount() const    { return cargoCount; }
+
+    Weight getRemainingCapacity(IdView trainId) {
+        Node* train = findTrain(trainId);
+        if (train == nullptr) return -1;
+        return train->maxWeight - train->cargo.getTotalWeight();
+    }
+
+    long long getTypeWeight(const Name& type) const {
+        auto it = typeTotals.find(type);
+        return it == typeTotals.end() ? 0 : it->second.weight;
+    }
+
+    const std::unordered_map<Name, TypeTotals>& getTypeTotals() const { return typeTotals; }
+
+    // ── Cargo queries — ranges of IndexedCargo handles (see CargoIndex.h) ─────
+    using CargoHit = typename CargoIndex<T, Node, Alloc>::Record;
+
+    auto findCargoByType(NameView type) const {
+        metrics::Scope m(metrics::Op::FleetQuery);
+        auto hits = cargoIndex.ofType(type);
+        m.visit(hits.size());
+        return hits;
+    }
+
+    auto findCargoByName(NameView name) const {
+        metrics::Scope m(metrics::Op::FleetQuery);
+        auto hits = cargoIndex.named(name);
+        m.visit(hits.size());
+        return hits;
+    }
+
+    auto findCargoByWeight(Weight minWeight, Weight maxWeight) const {
+        metrics::Scope m(metrics::Op::FleetQuery);
+        return cargoIndex.weighing(minWeight, maxWeight);
+    }
+
+    // ── forEachTrain — insertion order, fn(id, name, maxWeight, manifest) ────
+    template <typename Fn>
+    void forEachTrain(Fn fn) const {
+        for (const Node* cur = head; cur != nullptr; cur = cur->next)
+            fn(cur->id, cur->name, cur->maxWeight, cur->cargo);
+    }
+
+    // ── setSink — route fleet and manifest events (nullptr = silent) ─────────
+    void setSink(EventSink<Name>* s) {
+        sink = s;
+        for (Node* cur = head; cur != nullptr; cur = cur->next) cur->cargo.setSink(s);
+    }
+
+    EventSink<Name>* getSink() const { return sink; }
+
+    PoolStats getTrainPoolStats() const { return trainPool.stats(); }
+    PoolStats getCargoPoolStats() const { return cargoPool.stats(); }
 };
 
 #endif
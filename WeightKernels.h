@@ -0,0 +1,122 @@
+#ifndef WEIGHTKERNELS_H
+#define WEIGHTKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ── Weight kernels — reductions and scans over contiguous int arrays ─────────
+// Used by the structure-of-arrays manifest (CargoArray). With -mavx2 (or
+// -march=native) the AVX2 paths process 8 items per instruction; otherwise the
+// scalar loops are written so the compiler can auto-vectorize them (SSE/NEON).
+//
+// Functions:
+//   sumWeights()  — total of all weights, widened to 64 bits
+//   countAbove()  — how many weights are > x
+//   countEqual()  — how many ids are == y
+//   sumWhereEqual() — total weight of items whose id == y
+// The int overloads are the vectorized ones; wider weight types (a
+// FleetPolicy Weight, see FleetPolicy.h) take the plain template loops.
+namespace kernels {
+
+inline long long sumWeights(const int* w, std::size_t n) {
+    std::size_t i = 0;
+    long long total = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; ++i) total += w[i];
+    return total;
+}
+
+inline std::size_t countAbove(const int* w, std::size_t n, int x) {
+    std::size_t i = 0, count = 0;
+#if defined(__AVX2__)
+    const __m256i limit = _mm256_set1_epi32(x);
+    const std::size_t kFlush = std::size_t(8) << 30;  // keeps 32-bit lanes from overflowing
+    while (i + 8 <= n) {
+        __m256i acc = _mm256_setzero_si256();
+        std::size_t blockEnd = (n - i > kFlush) ? i + kFlush : n;
+        for (; i + 8 <= blockEnd; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+            acc = _mm256_sub_epi32(acc, _mm256_cmpgt_epi32(v, limit));  // mask is -1
+        }
+        alignas(32) std::uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        for (std::uint32_t lane : lanes) count += lane;
+    }
+#endif
+    for (; i < n; ++i) count += (w[i] > x);
+    return count;
+}
+
+inline std::size_t countEqual(const int* ids, std::size_t n, int y) {
+    std::size_t i = 0, count = 0;
+#if defined(__AVX2__)
+    const __m256i key = _mm256_set1_epi32(y);
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, key)));
+        count += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+    }
+#endif
+    for (; i < n; ++i) count += (ids[i] == y);
+    return count;
+}
+
+inline long long sumWhereEqual(const int* w, const int* ids, std::size_t n, int y) {
+    std::size_t i = 0;
+    long long total = 0;
+#if defined(__AVX2__)
+    const __m256i key = _mm256_set1_epi32(y);
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + i));
+        __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i));
+        v = _mm256_and_si256(v, _mm256_cmpeq_epi32(k, key));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; ++i) total += (ids[i] == y) ? w[i] : 0;
+    return total;
+}
+
+template <typename W>
+long long sumWeights(const W* w, std::size_t n) {
+    long long total = 0;
+    for (std::size_t i = 0; i < n; ++i) total += w[i];
+    return total;
+}
+
+template <typename W>
+std::size_t countAbove(const W* w, std::size_t n, W x) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) count += (w[i] > x);
+    return count;
+}
+
+template <typename W>
+long long sumWhereEqual(const W* w, const int* ids, std::size_t n, int y) {
+    long long total = 0;
+    for (std::size_t i = 0; i < n; ++i) total += (ids[i] == y) ? w[i] : 0;
+    return total;
+}
+
+}  // namespace kernels
+
+#endif
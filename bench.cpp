@@ -0,0 +1,420 @@
+// bench — throughput and latency benchmarks for fleet, manifest and route ops
+//
+//   g++ -std=c++17 -O2 -march=native -o bench bench.cpp
+//   ./bench [--format json|csv] [--out file] [--sizes 10,100,...]
+//           [--dist uniform|zipf|both] [--backend list|array|both]
+//           [--ops N] [--budget-ms M]
+//
+// Every container runs with its event sink set to nullptr, so nothing is
+// formatted or printed while timing. Each case times up to --ops individual
+// operations (stopping early once --budget-ms of timed work has accumulated,
+// which keeps the O(n) operations at 10^6 bounded) and reports throughput plus
+// latency percentiles. Per-op timing includes one steady_clock read pair.
+//
+// Cases (size = trains, manifest items or stations already present):
+//   fleet.addTrain      building the fleet up to size
+//   fleet.loadCargo     one item onto a train picked by the key distribution
+//   fleet.lookup        getRemainingCapacity() — the findTrain() path; also
+//                       run with backend "fixedkey": a fleet on
+//                       FleetPolicy<FixedKey<16>, std::string, int>, so the
+//                       same lookups hash and compare packed integers
+//   fleet.findCargo     findCargoByName() on a loaded item — the cargo index
+//   fleet.unloadCargo   the same items, same train order
+//   manifest.loadCargo / manifest.getTotalWeight / manifest.unloadCargo
+//   manifest.updateWeight  reweigh a picked item through its handle
+//   route.addStation / route.advanceStation / route.removeStation
+//   route.advanceBy     jump a picked number of stations ahead
+//   route.distanceTo    stops from the fleet to a picked station
+//
+// --dist picks which keys ops hit: uniform, or zipf (s = 0.99, hot keys
+// scattered over the ID space). --backend picks the manifest type used by the
+// fleet and manifest cases (CargoList or CargoArray); route cases report
+// backend "loop" and run once per distribution.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "TrainFleet.h"
+#include "RouteLoop.h"
+#include "FixedKey.h"
+
+using Clock = std::chrono::steady_clock;
+
+// ── Options ──────────────────────────────────────────────────────────────────
+struct Options {
+    std::string format = "json";
+    std::string out;
+    std::vector<std::size_t> sizes = {10, 100, 1000, 10000, 100000, 1000000};
+    std::vector<std::string> dists = {"uniform", "zipf"};
+    std::vector<std::string> backends = {"list", "array"};
+    std::size_t ops = 100000;
+    double budgetMs = 1000;
+};
+
+// ── Result — one row of output ───────────────────────────────────────────────
+struct Result {
+    std::string name, backend, dist;
+    std::size_t size = 0;
+    std::size_t ops  = 0;
+    double seconds = 0, opsPerSec = 0, meanNs = 0;
+    double p50 = 0, p90 = 0, p99 = 0, p999 = 0, maxNs = 0;
+};
+
+// ── Recorder — per-op latencies for one case ─────────────────────────────────
+class Recorder {
+private:
+    std::vector<std::uint64_t> samples;
+    std::uint64_t totalNs = 0;
+    std::uint64_t budgetNs;
+
+public:
+    Recorder(std::size_t ops, double budgetMs)
+        : budgetNs(static_cast<std::uint64_t>(budgetMs * 1e6)) { samples.reserve(ops); }
+
+    template <typename Fn>
+    void time(Fn fn) {
+        Clock::time_point t0 = Clock::now();
+        fn();
+        std::uint64_t ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+        samples.push_back(ns);
+        totalNs += ns;
+    }
+
+    bool overBudget() const { return totalNs >= budgetNs; }
+
+    Result finish(const std::string& name, const std::string& backend,
+                  const std::string& dist, std::size_t size) {
+        Result r;
+        r.name = name; r.backend = backend; r.dist = dist; r.size = size;
+        r.ops = samples.size();
+        if (samples.empty()) return r;
+        r.seconds   = totalNs / 1e9;
+        r.opsPerSec = r.seconds > 0 ? r.ops / r.seconds : 0;
+        r.meanNs    = static_cast<double>(totalNs) / r.ops;
+        auto pct = [this](double p) {
+            std::size_t k = static_cast<std::size_t>(p * (samples.size() - 1));
+            std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+            return static_cast<double>(samples[k]);
+        };
+        r.p50 = pct(0.50); r.p90 = pct(0.90); r.p99 = pct(0.99); r.p999 = pct(0.999);
+        r.maxNs = static_cast<double>(*std::max_element(samples.begin(), samples.end()));
+        return r;
+    }
+};
+
+// ── KeyPicker — indices in [0, n) under a uniform or zipf distribution ───────
+class KeyPicker {
+private:
+    std::mt19937_64 rng;
+    std::size_t n;
+    bool zipf;
+    std::vector<double> cdf;          // zipf only
+    std::vector<std::uint32_t> perm;  // zipf rank -> key, so hot keys are spread out
+
+public:
+    KeyPicker(std::size_t n, const std::string& dist, std::uint64_t seed)
+        : rng(seed), n(n), zipf(dist == "zipf") {
+        if (!zipf) return;
+        const double s = 0.99;
+        cdf.resize(n);
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) cdf[i] = sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+        for (double& c : cdf) c /= sum;
+        perm.resize(n);
+        for (std::size_t i = 0; i < n; ++i) perm[i] = static_cast<std::uint32_t>(i);
+        std::shuffle(perm.begin(), perm.end(), rng);
+    }
+
+    std::size_t next() {
+        if (!zipf) return std::uniform_int_distribution<std::size_t>(0, n - 1)(rng);
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        std::size_t rank = static_cast<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+        return perm[std::min(rank, n - 1)];
+    }
+};
+
+std::vector<std::string> makeNames(const char* prefix, std::size_t n) {
+    std::vector<std::string> v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) v.push_back(prefix + std::to_string(i));
+    return v;
+}
+
+// ── Fleet cases — addTrain, loadCargo, lookup, unloadCargo ───────────────────
+template <typename Manifest>
+void benchFleet(const Options& opt, const std::string& backend, const std::string& dist,
+                std::size_t n, std::vector<Result>& out) {
+    TrainFleet<std::string, NodePool, Manifest> fleet;
+    fleet.setSink(nullptr);
+    const std::vector<std::string> ids = makeNames("T-", n);
+
+    Recorder add(n, opt.budgetMs);
+    std::size_t built = 0;
+    for (; built < n && !add.overBudget(); ++built)
+        add.time([&] { fleet.addTrain(ids[built], "Bench", 1 << 30); });
+    for (std::size_t i = built; i < n; ++i) fleet.addTrain(ids[i], "Bench", 1 << 30);
+    out.push_back(add.finish("fleet.addTrain", backend, dist, n));
+
+    KeyPicker picker(n, dist, 42);
+    std::vector<std::size_t> keys(opt.ops);
+    for (std::size_t& k : keys) k = picker.next();
+    const std::vector<std::string> items = makeNames("C-", opt.ops);
+
+    Recorder load(opt.ops, opt.budgetMs);
+    std::size_t loaded = 0;
+    for (; loaded < opt.ops && !load.overBudget(); ++loaded) {
+        Cargo<std::string> cargo(items[loaded], "Bench", 1);
+        load.time([&] { fleet.loadCargo(ids[keys[loaded]], cargo); });
+    }
+    out.push_back(load.finish("fleet.loadCargo", backend, dist, n));
+
+    Recorder lookup(opt.ops, opt.budgetMs);
+    long long sink = 0;
+    for (std::size_t i = 0; i < opt.ops && !lookup.overBudget(); ++i)
+        lookup.time([&] { sink += fleet.getRemainingCapacity(ids[keys[i]]); });
+    out.push_back(lookup.finish("fleet.lookup", backend, dist, n));
+
+    Recorder find(loaded, opt.budgetMs);
+    for (std::size_t i = 0; i < loaded && !find.overBudget(); ++i)
+        find.time([&] { sink += fleet.findCargoByName(items[i]).size(); });
+    out.push_back(find.finish("fleet.findCargo", backend, dist, n));
+
+    Recorder unload(loaded, opt.budgetMs);
+    for (std::size_t i = 0; i < loaded && !unload.overBudget(); ++i)
+        unload.time([&] { fleet.unloadCargo(ids[keys[i]], items[i]); });
+    out.push_back(unload.finish("fleet.unloadCargo", backend, dist, n));
+
+    if (sink == 42) std::fputc(' ', stderr);  // keep the lookups observable
+}
+
+// ── Fixed-key lookup — fleet.lookup with packed train IDs ────────────────────
+// Same IDs and key order as benchFleet's lookup; the IDs are packed once up
+// front, as a caller holding FixedKeys would.
+void benchFixedKeyLookup(const Options& opt, const std::string& dist, std::size_t n,
+                         std::vector<Result>& out) {
+    using Id = FixedKey<16>;
+    TrainFleet<FleetPolicy<Id, std::string, int>, NodePool> fleet;
+    fleet.setSink(nullptr);
+    const std::vector<std::string> names = makeNames("T-", n);
+    const std::vector<Id> ids(names.begin(), names.end());
+    for (const Id& id : ids) fleet.addTrain(id, "Bench", 1 << 30);
+
+    KeyPicker picker(n, dist, 42);
+    std::vector<std::size_t> keys(opt.ops);
+    for (std::size_t& k : keys) k = picker.next();
+
+    Recorder lookup(opt.ops, opt.budgetMs);
+    long long sink = 0;
+    for (std::size_t i = 0; i < opt.ops && !lookup.overBudget(); ++i)
+        lookup.time([&] { sink += fleet.getRemainingCapacity(ids[keys[i]]); });
+    out.push_back(lookup.finish("fleet.lookup", "fixedkey", dist, n));
+
+    if (sink == 42) std::fputc(' ', stderr);
+}
+
+// ── Manifest cases — one manifest holding n items ────────────────────────────
+template <typename Manifest>
+void benchManifest(const Options& opt, const std::string& backend, const std::string& dist,
+                   std::size_t n, std::vector<Result>& out) {
+    Manifest manifest;
+    manifest.setSink(nullptr);
+    const std::vector<std::string> items = makeNames("C-", n);
+    std::vector<typename Manifest::Handle> handles(n);
+
+    Recorder load(n, opt.budgetMs);
+    std::size_t built = 0;
+    for (; built < n && !load.overBudget(); ++built) {
+        Cargo<std::string> cargo(items[built], "Bench", static_cast<int>(built % 100));
+        load.time([&] { manifest.loadCargo(cargo, &handles[built]); });
+    }
+    for (std::size_t i = built; i < n; ++i)
+        manifest.loadCargo(Cargo<std::string>(items[i], "Bench", static_cast<int>(i % 100)), &handles[i]);
+    out.push_back(load.finish("manifest.loadCargo", backend, dist, n));
+
+    Recorder total(opt.ops, opt.budgetMs);
+    long long sink = 0;
+    for (std::size_t i = 0; i < opt.ops && !total.overBudget(); ++i)
+        total.time([&] { sink += manifest.getTotalWeight(); });
+    out.push_back(total.finish("manifest.getTotalWeight", backend, dist, n));
+
+    KeyPicker reweighPicker(n, dist, 5);
+    Recorder reweigh(opt.ops, opt.budgetMs);
+    for (std::size_t i = 0; i < opt.ops && !reweigh.overBudget(); ++i) {
+        std::size_t k = reweighPicker.next();
+        reweigh.time([&] { manifest.updateWeight(handles[k], static_cast<int>(i % 100)); });
+    }
+    out.push_back(reweigh.finish("manifest.updateWeight", backend, dist, n));
+
+    // Unload an item picked by the distribution, then put it back (untimed).
+    KeyPicker picker(n, dist, 7);
+    Recorder unload(opt.ops, opt.budgetMs);
+    for (std::size_t i = 0; i < opt.ops && !unload.overBudget(); ++i) {
+        std::size_t k = picker.next();
+        unload.time([&] { manifest.unloadCargo(items[k]); });
+        manifest.loadCargo(Cargo<std::string>(items[k], "Bench", static_cast<int>(k % 100)));
+    }
+    out.push_back(unload.finish("manifest.unloadCargo", backend, dist, n));
+
+    if (sink == 42) std::fputc(' ', stderr);
+}
+
+// ── Route cases — a loop of n stations ───────────────────────────────────────
+void benchRoute(const Options& opt, const std::string& dist, std::size_t n,
+                std::vector<Result>& out) {
+    RouteLoop<std::string> route;
+    route.setSink(nullptr);
+    const std::vector<std::string> names = makeNames("S-", n);
+    route.addStations(names);
+
+    // Append a fresh station, then remove it again (untimed) to hold size at n.
+    Recorder add(opt.ops, opt.budgetMs);
+    const std::string extra = "S-extra";
+    for (std::size_t i = 0; i < opt.ops && !add.overBudget(); ++i) {
+        add.time([&] { route.addStation(extra); });
+        route.removeStation(extra);
+    }
+    out.push_back(add.finish("route.addStation", "loop", dist, n));
+
+    Recorder advance(opt.ops, opt.budgetMs);
+    for (std::size_t i = 0; i < opt.ops && !advance.overBudget(); ++i)
+        advance.time([&] { route.advanceStation(); });
+    out.push_back(advance.finish("route.advanceStation", "loop", dist, n));
+
+    KeyPicker picker(n, dist, 99);
+    Recorder remove(opt.ops, opt.budgetMs);
+    for (std::size_t i = 0; i < opt.ops && !remove.overBudget(); ++i) {
+        std::size_t k = picker.next();
+        remove.time([&] { route.removeStation(names[k]); });
+        route.addStation(names[k]);
+    }
+    out.push_back(remove.finish("route.removeStation", "loop", dist, n));
+
+    Recorder jump(opt.ops, opt.budgetMs);
+    for (std::size_t i = 0; i < opt.ops && !jump.overBudget(); ++i) {
+        long long k = static_cast<long long>(picker.next());
+        jump.time([&] { route.advanceBy(k); });
+    }
+    out.push_back(jump.finish("route.advanceBy", "loop", dist, n));
+
+    Recorder distance(opt.ops, opt.budgetMs);
+    long long total = 0;
+    for (std::size_t i = 0; i < opt.ops && !distance.overBudget(); ++i) {
+        std::size_t k = picker.next();
+        distance.time([&] { total += route.distanceTo(names[k]); });
+    }
+    out.push_back(distance.finish("route.distanceTo", "loop", dist, n));
+    if (total == -1) std::fputc(' ', stderr);  // keep the queries observable
+}
+
+// ── Output ───────────────────────────────────────────────────────────────────
+void writeJson(std::ostream& os, const std::vector<Result>& rows) {
+    os << "[\n";
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const Result& r = rows[i];
+        os << "  {\"case\": \"" << r.name << "\", \"backend\": \"" << r.backend
+           << "\", \"dist\": \"" << r.dist << "\", \"size\": " << r.size
+           << ", \"ops\": " << r.ops << ", \"seconds\": " << r.seconds
+           << ", \"ops_per_sec\": " << r.opsPerSec << ", \"mean_ns\": " << r.meanNs
+           << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90
+           << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999
+           << ", \"max_ns\": " << r.maxNs << "}" << (i + 1 < rows.size() ? ",\n" : "\n");
+    }
+    os << "]\n";
+}
+
+void writeCsv(std::ostream& os, const std::vector<Result>& rows) {
+    os << "case,backend,dist,size,ops,seconds,ops_per_sec,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n";
+    for (const Result& r : rows) {
+        os << r.name << ',' << r.backend << ',' << r.dist << ',' << r.size << ',' << r.ops << ','
+           << r.seconds << ',' << r.opsPerSec << ',' << r.meanNs << ',' << r.p50 << ','
+           << r.p90 << ',' << r.p99 << ',' << r.p999 << ',' << r.maxNs << '\n';
+    }
+}
+
+// Comma-separated list; "both" expands to both choices.
+std::vector<std::string> splitList(const std::string& s, std::vector<std::string> both) {
+    if (s == "both") return both;
+    std::vector<std::string> v;
+    std::stringstream ss(s);
+    for (std::string item; std::getline(ss, item, ',');) v.push_back(item);
+    return v;
+}
+
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [--format json|csv] [--out file] [--sizes 10,100,...]\n"
+              << "       [--dist uniform|zipf|both] [--backend list|array|both]\n"
+              << "       [--ops N] [--budget-ms M]\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string val = argv[++i];
+        if      (arg == "--format")    opt.format = val;
+        else if (arg == "--out")       opt.out = val;
+        else if (arg == "--dist")      opt.dists = splitList(val, {"uniform", "zipf"});
+        else if (arg == "--backend")   opt.backends = splitList(val, {"list", "array"});
+        else if (arg == "--ops")       opt.ops = std::strtoull(val.c_str(), nullptr, 10);
+        else if (arg == "--budget-ms") opt.budgetMs = std::atof(val.c_str());
+        else if (arg == "--sizes") {
+            opt.sizes.clear();
+            for (const std::string& s : splitList(val, {})) opt.sizes.push_back(std::strtoull(s.c_str(), nullptr, 10));
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if ((opt.format != "json" && opt.format != "csv") || opt.ops == 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Result> rows;
+    for (std::size_t n : opt.sizes) {
+        if (n == 0) continue;
+        for (const std::string& dist : opt.dists) {
+            for (const std::string& backend : opt.backends) {
+                std::cerr << "[bench] size " << n << ", " << dist << ", " << backend << "\n";
+                if (backend == "array") {
+                    benchFleet<CargoArray<std::string>>(opt, backend, dist, n, rows);
+                    benchManifest<CargoArray<std::string>>(opt, backend, dist, n, rows);
+                } else {
+                    benchFleet<CargoList<std::string>>(opt, backend, dist, n, rows);
+                    benchManifest<CargoList<std::string>>(opt, backend, dist, n, rows);
+                }
+            }
+            std::cerr << "[bench] size " << n << ", " << dist << ", fixedkey\n";
+            benchFixedKeyLookup(opt, dist, n, rows);
+            std::cerr << "[bench] size " << n << ", " << dist << ", route\n";
+            benchRoute(opt, dist, n, rows);
+        }
+    }
+
+    std::ofstream file;
+    if (!opt.out.empty()) {
+        file.open(opt.out);
+        if (!file) {
+            std::cerr << "[bench] cannot write " << opt.out << "\n";
+            return 1;
+        }
+    }
+    std::ostream& os = opt.out.empty() ? std::cout : file;
+    if (opt.format == "csv") writeCsv(os, rows);
+    else                     writeJson(os, rows);
+    return 0;
+}
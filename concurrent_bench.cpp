@@ -0,0 +1,223 @@
+// concurrent_bench — stress test and thread-scaling benchmark for ConcurrentFleet
+//
+//   g++ -std=c++17 -O2 -pthread -o concurrent_bench concurrent_bench.cpp
+//   ./concurrent_bench [maxThreads] [opsPerThread]
+//
+// Stress phase: threads mix loads, unloads, batch loads and train add/remove
+// on a shared pool of IDs, then the fleet's counters are checked against a
+// full walk (and every train against its capacity). Meanwhile a reader thread
+// takes fleet snapshots and checks every captured manifest is self-consistent.
+// A second check has every thread race 1-ton loads onto one train and
+// verifies exactly maxWeight of them succeed.
+//
+// Scaling phase: 1..maxThreads threads each load/unload on their own trains;
+// the single-mutex TrainFleet is measured alongside as the baseline.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentFleet.h"
+
+using Clock = std::chrono::steady_clock;
+
+// ── LockedFleet — TrainFleet behind one mutex (the baseline) ─────────────────
+class LockedFleet {
+private:
+    std::mutex m;
+    TrainFleet<std::string> fleet;
+
+public:
+    LockedFleet() { fleet.setSink(nullptr); }
+
+    OpResult addTrain(const std::string& id, const std::string& name, int maxWeight) {
+        std::lock_guard<std::mutex> lock(m);
+        return fleet.addTrain(id, name, maxWeight);
+    }
+
+    OpResult loadCargo(const std::string& id, Cargo<std::string> cargo) {
+        std::lock_guard<std::mutex> lock(m);
+        return fleet.loadCargo(id, std::move(cargo));
+    }
+
+    OpResult unloadCargo(const std::string& id, const std::string& name) {
+        std::lock_guard<std::mutex> lock(m);
+        return fleet.unloadCargo(id, name);
+    }
+};
+
+std::string trainId(int i) { return "T-" + std::to_string(i); }
+
+// ── stress — random mixed operations, then invariant checks ──────────────────
+bool stress(int threads, int opsPerThread) {
+    const int kTrains = 64;
+    ConcurrentFleet<std::string> fleet(16);
+    for (int i = 0; i < kTrains; ++i) fleet.addTrain(trainId(i), "Train " + std::to_string(i), 5000);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&fleet, t, opsPerThread]() {
+            std::mt19937 rng(1234u + static_cast<unsigned>(t));
+            std::uniform_int_distribution<int> pickTrain(0, kTrains - 1), pickOp(0, 99),
+                                               pickWeight(1, 200), pickItem(0, 31);
+            const std::string tag = "w" + std::to_string(t) + "-";
+            for (int i = 0; i < opsPerThread; ++i) {
+                std::string id = trainId(pickTrain(rng));
+                int op = pickOp(rng);
+                if (op < 50) {
+                    fleet.loadCargo(id, Cargo<std::string>(tag + std::to_string(pickItem(rng)),
+                                                           "Bulk", pickWeight(rng)));
+                } else if (op < 85) {
+                    fleet.unloadCargo(id, tag + std::to_string(pickItem(rng)));
+                } else if (op < 95) {
+                    std::vector<Cargo<std::string>> batch;
+                    for (int k = 0; k < 4; ++k)
+                        batch.emplace_back(tag + std::to_string(pickItem(rng)), "Mixed", pickWeight(rng));
+                    fleet.loadCargoBatch(id, batch);
+                } else if (op < 98) {
+                    fleet.removeTrain(id);
+                } else {
+                    fleet.addTrain(id, "Replacement", 5000);
+                }
+            }
+        });
+    }
+    // Reader: every version must agree with its own totals and capacity,
+    // however the writers interleave.
+    std::atomic<bool> writing(true);
+    long long snapshots = 0, torn = 0;
+    std::thread reader([&]() {
+        while (writing) {
+            for (const auto& train : fleet.snapshot().trains) {
+                long long sum = 0;
+                int n = 0;
+                train.manifest().forEach([&](const std::string&, const std::string&, int w) { sum += w; n++; });
+                if (sum != train.manifest().getTotalWeight() || n != train.manifest().getCount()
+                    || sum > train.maxWeight())
+                    torn++;
+            }
+            snapshots++;
+        }
+    });
+    for (std::thread& w : workers) w.join();
+    writing = false;
+    reader.join();
+
+    long long weight = 0, capacity = 0, items = 0;
+    int trains = 0;
+    bool ok = torn == 0;
+    fleet.forEachTrain([&](const std::string& id, const std::string&, int maxWeight,
+                           const ManifestVersion<std::string>& cargo) {
+        long long sum = 0;
+        cargo.forEach([&sum](const std::string&, const std::string&, int w) { sum += w; });
+        if (sum != cargo.getTotalWeight() || sum > maxWeight) {
+            std::printf("  FAIL train %s: %lld/%d tons (manifest says %d)\n",
+                        id.c_str(), sum, maxWeight, cargo.getTotalWeight());
+            ok = false;
+        }
+        weight   += sum;
+        capacity += maxWeight;
+        items    += cargo.getCount();
+        trains++;
+    });
+    if (weight != fleet.getTotalWeight() || capacity != fleet.getTotalCapacity() ||
+        items != fleet.getCargoCount() || trains != fleet.getSize()) {
+        std::printf("  FAIL counters: weight %lld/%lld capacity %lld/%lld items %lld/%lld trains %d/%d\n",
+                    weight, fleet.getTotalWeight(), capacity, fleet.getTotalCapacity(),
+                    items, fleet.getCargoCount(), trains, fleet.getSize());
+        ok = false;
+    }
+    std::printf("  mixed ops   %d threads x %d: %d trains, %lld items, %lld tons  %s\n",
+                threads, opsPerThread, trains, items, weight, ok ? "OK" : "FAILED");
+    std::printf("  snapshots   %lld taken during the run, %lld inconsistent\n", snapshots, torn);
+    return ok;
+}
+
+// Every thread races 1-ton loads onto one train; exactly maxWeight must land.
+bool capacityRace(int threads) {
+    const int kMax = 10000;
+    ConcurrentFleet<std::string> fleet;
+    fleet.addTrain("T-0", "Contended", kMax);
+
+    std::atomic<int> loaded(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&fleet, &loaded]() {
+            for (int i = 0; i < kMax; ++i)
+                if (fleet.loadCargo("T-0", Cargo<std::string>("Pebble", "Bulk", 1)) == OpResult::Ok)
+                    loaded++;
+        });
+    }
+    for (std::thread& w : workers) w.join();
+
+    bool ok = loaded == kMax && fleet.getTotalWeight() == kMax && fleet.getRemainingCapacity("T-0") == 0;
+    std::printf("  capacity    %d threads: %d/%d loads accepted  %s\n",
+                threads, loaded.load(), kMax, ok ? "OK" : "FAILED");
+    return ok;
+}
+
+// ── scale — per-thread trains, load then unload, ops per second ──────────────
+template <typename Fleet>
+double measure(Fleet& fleet, int threads, int opsPerThread) {
+    const int kTrainsPerThread = 8;
+    for (int t = 0; t < threads; ++t)
+        for (int k = 0; k < kTrainsPerThread; ++k)
+            fleet.addTrain(trainId(t * kTrainsPerThread + k), "Bench", 1 << 30);
+
+    std::vector<std::thread> workers;
+    Clock::time_point start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&fleet, t, opsPerThread]() {
+            std::vector<std::string> ids;
+            for (int k = 0; k < kTrainsPerThread; ++k) ids.push_back(trainId(t * kTrainsPerThread + k));
+            const std::string item = "Crate";
+            for (int i = 0; i < opsPerThread / 2; ++i) {
+                const std::string& id = ids[static_cast<std::size_t>(i) % ids.size()];
+                fleet.loadCargo(id, Cargo<std::string>(item, "Bench", 1));
+                fleet.unloadCargo(id, item);
+            }
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(threads) * (opsPerThread / 2 * 2) / seconds;
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = static_cast<int>(std::thread::hardware_concurrency());
+    if (maxThreads < 1) maxThreads = 1;
+    int ops = 400000;
+    if (argc > 1) maxThreads = std::atoi(argv[1]);
+    if (argc > 2) ops = std::atoi(argv[2]);
+    if (maxThreads < 1 || ops < 2) {
+        std::fprintf(stderr, "Usage: %s [maxThreads] [opsPerThread]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("Stress\n");
+    bool ok = stress(maxThreads, ops / 4) && capacityRace(maxThreads);
+
+    std::printf("\nScaling (%d ops per thread)\n", ops);
+    std::printf("  %-8s %16s %9s %16s %9s\n", "threads", "sharded ops/s", "speedup", "one-lock ops/s", "speedup");
+    std::vector<int> steps;  // 1, 2, 4, ... and maxThreads itself
+    for (int threads = 1; threads < maxThreads; threads *= 2) steps.push_back(threads);
+    steps.push_back(maxThreads);
+
+    double base = 0, lockedBase = 0;
+    for (int threads : steps) {
+        ConcurrentFleet<std::string> sharded;
+        LockedFleet locked;
+        double a = measure(sharded, threads, ops);
+        double b = measure(locked, threads, ops);
+        if (threads == 1) {
+            base = a;
+            lockedBase = b;
+        }
+        std::printf("  %-8d %16.0f %8.2fx %16.0f %8.2fx\n", threads, a, a / base, b, b / lockedBase);
+    }
+    return ok ? 0 : 1;
+}
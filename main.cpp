@@ -1,8 +1,30 @@
 #include <iostream>
 #include <string>
 #include <limits>
+#include <memory>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
 #include "TrainFleet.h"
 #include "RouteLoop.h"
+#include "BatchRunner.h"
+#include "Snapshot.h"
+#include "Journal.h"
+#include "Exporter.h"
+#include "FleetServer.h"
+#include "Symbol.h"
+
+// ── Key type — build with -DTRAIN_CARGO_SYMBOLS to intern every id and name ──
+#ifdef TRAIN_CARGO_SYMBOLS
+using Key = Symbol;
+#else
+using Key = std::string;
+#endif
+using Fleet = TrainFleet<Key>;
+using Route = RouteLoop<Key>;
 
 void printMenu() {
     std::cout << "\n====== Train Cargo Management ======\n"
@@ -10,7 +32,7 @@ void printMenu() {
               << " 1. Display full fleet\n"
               << " 2. Add train to fleet\n"
               << " 3. Remove train from fleet\n"
-              << "-- Cargo (Nested Singly Linked List) --\n"
+              << "-- Cargo (Nested Doubly Linked List) --\n"
               << " 4. Load cargo onto train\n"
               << " 5. Unload cargo from train\n"
               << " 6. Display one train's manifest\n"
@@ -19,6 +41,8 @@ void printMenu() {
               << " 8. Add station to route\n"
               << " 9. Remove station from route\n"
               << "10. Advance fleet to next station\n"
+              << "-- Diagnostics --\n"
+              << "11. Show operation stats\n"
               << " 0. Exit\n"
               << "====================================\n"
               << "Choice: ";
@@ -40,30 +64,319 @@ int readInt(const std::string& prompt) {
     return val;
 }
 
-int main() {
-    TrainFleet<std::string> fleet;
-    RouteLoop<std::string>  route;
+void printUsage(const char* prog) {
+    std::cerr << "Usage: " << prog << "                    interactive menu\n"
+              << "       " << prog << " --batch <file|-> [--events none|text|binary]\n"
+              << "         replay a command log (see BatchRunner.h) from a file or stdin;\n"
+              << "         events go to stdout, default none\n"
+              << "  --snapshot <file>  start from this snapshot if it exists (instead of\n"
+              << "                     sample data / an empty fleet) and save back on exit\n"
+              << "  --journal <file>   log every change; replayed on top of the snapshot at\n"
+              << "                     startup, folded into it on exit\n"
+              << "  --sync none|async|group   journal durability (default async)\n"
+              << "       " << prog << " --export cargo|fleet|route [--format csv|jsonl|table]\n"
+              << "         [--out <file>] [--train <id>] [--type <type>] [--offset n] [--limit n]\n"
+              << "         write the restored state (see Exporter.h) to stdout or a file\n"
+              << "         and exit; default format csv\n"
+              << "       " << prog << " --serve <socket path|port> [--io-threads n]\n"
+              << "         serve batch commands to many clients over a Unix socket or\n"
+              << "         127.0.0.1:port (see FleetServer.h) until SIGINT/SIGTERM\n";
+}
 
-    // ── Pre-load sample data ──────────────────────────────────────────────────
+// ── loadSampleData — the demo fleet and route used when nothing is restored ──
+template <typename Fleet, typename Route>
+void loadSampleData(Fleet& fleet, Route& route) {
     // Fleet — singly linked list of trains
     fleet.addTrain("T-01", "Iron Horse",   500);
     fleet.addTrain("T-02", "Steel Falcon", 300);
     fleet.addTrain("T-03", "Coal Runner",  800);
 
     // Cargo — nested singly linked list inside each train
-    fleet.loadCargo("T-01", Cargo<std::string>("Steel Beams",   "Industrial", 120));
-    fleet.loadCargo("T-01", Cargo<std::string>("Lumber",        "Raw Material", 80));
-    fleet.loadCargo("T-02", Cargo<std::string>("Electronics",   "Fragile",    50));
-    fleet.loadCargo("T-03", Cargo<std::string>("Coal",          "Bulk",       400));
-    fleet.loadCargo("T-03", Cargo<std::string>("Grain Sacks",   "Food",       200));
+    fleet.loadCargo("T-01", Cargo<Key>("Steel Beams",   "Industrial", 120));
+    fleet.loadCargo("T-01", Cargo<Key>("Lumber",        "Raw Material", 80));
+    fleet.loadCargo("T-02", Cargo<Key>("Electronics",   "Fragile",    50));
+    fleet.loadCargo("T-03", Cargo<Key>("Coal",          "Bulk",       400));
+    fleet.loadCargo("T-03", Cargo<Key>("Grain Sacks",   "Food",       200));
 
     // Route — circular linked list of stations
     route.addStation("Central Depot");
     route.addStation("Northgate Yard");
     route.addStation("Eastport Terminal");
     route.addStation("Southfield Hub");
+}
+
+// ── loadSnapshot / saveSnapshot — optional persistence around a session ──────
+// Returns false (silently) when there is no snapshot yet.
+bool loadSnapshot(const std::string& path, Fleet& fleet,
+                  Route& route, std::uint64_t* journalSeq) {
+    if (path.empty() || access(path.c_str(), F_OK) != 0) return false;
+    SnapshotView view;
+    if (!view.open(path)) {
+        std::cerr << "[Snapshot] " << path << ": " << view.error() << "\n";
+        return false;
+    }
+    if (!restoreSnapshot(view, fleet, route)) {
+        std::cerr << "[Snapshot] " << path
+                  << ": contents rejected (duplicate id or station, or overweight manifest)\n";
+        return false;
+    }
+    *journalSeq = view.journalSeq();
+    std::cerr << "[Snapshot] Loaded " << view.trainCount() << " trains, "
+              << view.cargoCount() << " cargo items, " << view.stationCount()
+              << " stations from " << path << "\n";
+    return true;
+}
+
+void saveSnapshot(const std::string& path, const Fleet& fleet,
+                  const Route& route) {
+    if (path.empty()) return;
+    std::string error;
+    if (writeSnapshot(path, fleet, route, &error))
+        std::cerr << "[Snapshot] Saved to " << path << "\n";
+    else
+        std::cerr << "[Snapshot] " << path << ": " << error << "\n";
+}
+
+// ── Persistence — optional snapshot + journal around a session ───────────────
+struct Persistence {
+    std::string snapshotPath;
+    std::string journalPath;
+    Journal::SyncMode syncMode = Journal::SyncMode::Async;
+    Journal journal;
+
+    // Snapshot first, then any newer journal records; true if state was restored.
+    // readOnly only replays the journal: it is not opened for appending, so a
+    // torn tail is left in place for the next writer to cut.
+    bool restore(Fleet& fleet, Route& route, bool readOnly = false) {
+        std::uint64_t seq = 0;
+        bool restored = loadSnapshot(snapshotPath, fleet, route, &seq);
+        if (journalPath.empty()) return restored;
+
+        JournalReplay replay = replayJournal(journalPath, fleet, route, seq);
+        if (replay.applied > 0 || replay.tornTail)
+            std::cerr << "[Journal] Replayed " << replay.applied << " operations from " << journalPath
+                      << (!replay.tornTail ? "" : readOnly ? " (ignored a torn tail)" : " (dropped a torn tail)")
+                      << "\n";
+        if (readOnly) return restored || replay.applied > 0;
+        std::string error;
+        if (!journal.open(journalPath, syncMode, replay.validBytes, replay.lastSeq + 1, &error))
+            std::cerr << "[Journal] " << journalPath << ": " << error << "\n";
+        return restored || replay.applied > 0;
+    }
+
+    // With a journal and a snapshot path, fold the journal into the snapshot.
+    void shutdown(const Fleet& fleet, const Route& route) {
+        if (!journal.isOpen()) {
+            saveSnapshot(snapshotPath, fleet, route);
+            return;
+        }
+        if (!snapshotPath.empty()) {
+            std::string error;
+            if (compactJournal(journal, snapshotPath, fleet, route, &error))
+                std::cerr << "[Snapshot] Saved to " << snapshotPath << ", journal compacted\n";
+            else
+                std::cerr << "[Snapshot] " << snapshotPath << ": " << error << "\n";
+        } else if (!journal.sync()) {
+            std::cerr << "[Journal] " << journalPath << ": " << journal.getError() << "\n";
+        }
+        journal.close();
+    }
+
+    Journal* log() { return journal.isOpen() ? &journal : nullptr; }
+};
+
+// ── runBatch — non-interactive replay, starts from an empty fleet and route ──
+int runBatch(const std::string& path, const std::string& events, Persistence& persistence) {
+    std::unique_ptr<EventSink<Key>> sink;
+    if      (events == "text")   sink.reset(new BufferedTextSink<Key>(STDOUT_FILENO));
+    else if (events == "binary") sink.reset(new BinaryEventSink<Key>(STDOUT_FILENO));
+    else if (events != "none") {
+        std::cerr << "Unknown --events mode \"" << events << "\"\n";
+        return 1;
+    }
+
+    int fd = (path == "-") ? STDIN_FILENO : open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open \"" << path << "\": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    Fleet fleetStore;
+    Route routeStore;
+    persistence.restore(fleetStore, routeStore);
+    fleetStore.setSink(sink.get());
+    routeStore.setSink(sink.get());
+
+    JournaledFleet<Fleet> fleet(fleetStore, persistence.log());
+    JournaledRoute<Route> route(routeStore, persistence.log());
+    BatchRunner<decltype(fleet), decltype(route)> runner(fleet, route);
+    auto start = std::chrono::steady_clock::now();
+    const BatchStats& st = runner.run(fd);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+    if (fd != STDIN_FILENO) close(fd);
+
+    std::cerr << "[Batch] " << st.lines << " lines, " << st.commands << " operations, "
+              << st.failed << " failed, " << st.parseErrors << " parse errors in "
+              << ms << " ms\n";
+    persistence.shutdown(fleetStore, routeStore);
+    return st.parseErrors == 0 ? 0 : 2;
+}
+
+// ── ExportRequest — the --export options ─────────────────────────────────────
+struct ExportRequest {
+    std::string what;    // cargo, fleet or route; empty = no export
+    std::string format = "csv";
+    std::string outPath; // empty = stdout
+    ExportFilter<Key> filter;
+};
 
-    std::cout << "\nSample data loaded. Fleet and route ready.\n";
+template <typename Int>
+bool parseCount(const char* text, Int& out) {
+    const char* end = text + std::strlen(text);
+    auto res = std::from_chars(text, end, out);
+    return res.ec == std::errc() && res.ptr == end;
+}
+
+// ── runExport — restore, stream one export, exit without saving ──────────────
+int runExport(const ExportRequest& req, Persistence& persistence) {
+    ExportFormat format;
+    if (!parseExportFormat(req.format, format)
+        || (req.what != "cargo" && req.what != "fleet" && req.what != "route")) {
+        std::cerr << "Unknown --export \"" << req.what << "\" or --format \"" << req.format << "\"\n";
+        return 1;
+    }
+    int fd = STDOUT_FILENO;
+    if (!req.outPath.empty()) {
+        fd = open(req.outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Cannot open \"" << req.outPath << "\": " << std::strerror(errno) << "\n";
+            return 1;
+        }
+    }
+
+    Fleet fleet;
+    Route route;
+    persistence.restore(fleet, route, true);  // read-only: nothing to log or fold
+
+    auto start = std::chrono::steady_clock::now();
+    Exporter<Key> exporter(fd, format);
+    ExportStats st;
+    if      (req.what == "cargo") st = exporter.cargo(fleet, req.filter);
+    else if (req.what == "fleet") st = exporter.fleet(fleet, req.filter);
+    else                          st = exporter.route(route, req.filter);
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+    if (fd != STDOUT_FILENO && close(fd) != 0) st.ok = false;
+
+    std::cerr << "[Export] " << st.rows << " rows, " << st.bytes << " bytes in " << ms << " ms"
+              << (st.more ? " (more rows past --limit)" : "") << "\n";
+    if (!st.ok) std::cerr << "[Export] write failed: " << std::strerror(errno) << "\n";
+    return st.ok ? 0 : 1;
+}
+
+#ifdef __linux__
+// ── runServer — serve the restored state until SIGINT or SIGTERM ─────────────
+int runServer(const std::string& listen, unsigned ioThreads, Persistence& persistence) {
+    ServerOptions options;
+    options.ioThreads = ioThreads;
+    if (!parseCount(listen.c_str(), options.tcpPort)) options.unixPath = listen;  // all digits = port
+
+    // Block the stop signals before any thread starts; only sigwait() sees them.
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    Fleet fleetStore;
+    Route routeStore;
+    persistence.restore(fleetStore, routeStore);
+    fleetStore.setSink(nullptr);
+    routeStore.setSink(nullptr);
+
+    {
+        JournaledFleet<Fleet> fleet(fleetStore, persistence.log());
+        JournaledRoute<Route> route(routeStore, persistence.log());
+        FleetServer<decltype(fleet), decltype(route)> server(fleet, route, options);
+        std::string error;
+        if (!server.start(&error)) {
+            std::cerr << "[Server] " << error << "\n";
+            return 1;
+        }
+        if (options.tcpPort >= 0) std::cerr << "[Server] Listening on 127.0.0.1:" << server.tcpPort() << "\n";
+        else                      std::cerr << "[Server] Listening on " << options.unixPath << "\n";
+
+        int signal = 0;
+        sigwait(&stopSignals, &signal);
+        server.stop();
+        const ServerStats& st = server.stats();
+        std::cerr << "[Server] Stopped: " << st.connections << " connections, " << st.lines
+                  << " commands in " << st.batches << " batches\n";
+    }
+    persistence.shutdown(fleetStore, routeStore);
+    return 0;
+}
+#endif
+
+int main(int argc, char** argv) {
+    std::string batchPath, serveOn, events = "none", sync = "async";
+    unsigned ioThreads = 1;
+    Persistence persistence;
+    ExportRequest exportReq;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if      (arg == "--batch"    && i + 1 < argc) batchPath = argv[++i];
+        else if (arg == "--events"   && i + 1 < argc) events    = argv[++i];
+        else if (arg == "--snapshot" && i + 1 < argc) persistence.snapshotPath = argv[++i];
+        else if (arg == "--journal"  && i + 1 < argc) persistence.journalPath  = argv[++i];
+        else if (arg == "--sync"     && i + 1 < argc) sync      = argv[++i];
+        else if (arg == "--serve"    && i + 1 < argc) serveOn   = argv[++i];
+        else if (arg == "--io-threads" && i + 1 < argc && parseCount(argv[i + 1], ioThreads)) ++i;
+        else if (arg == "--export"   && i + 1 < argc) exportReq.what    = argv[++i];
+        else if (arg == "--format"   && i + 1 < argc) exportReq.format  = argv[++i];
+        else if (arg == "--out"      && i + 1 < argc) exportReq.outPath = argv[++i];
+        else if (arg == "--train"    && i + 1 < argc) exportReq.filter.train = Key(argv[++i]);
+        else if (arg == "--type"     && i + 1 < argc) exportReq.filter.type  = Key(argv[++i]);
+        else if (arg == "--offset"   && i + 1 < argc && parseCount(argv[i + 1], exportReq.filter.offset)) ++i;
+        else if (arg == "--limit"    && i + 1 < argc && parseCount(argv[i + 1], exportReq.filter.limit))  ++i;
+        else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if      (sync == "none")  persistence.syncMode = Journal::SyncMode::None;
+    else if (sync == "group") persistence.syncMode = Journal::SyncMode::Group;
+    else if (sync != "async") {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!exportReq.what.empty()) return runExport(exportReq, persistence);
+    if (!serveOn.empty()) {
+#ifdef __linux__
+        return runServer(serveOn, ioThreads, persistence);
+#else
+        std::cerr << "--serve needs Linux (epoll)\n";
+        return 1;
+#endif
+    }
+    if (!batchPath.empty()) return runBatch(batchPath, events, persistence);
+
+    Fleet fleetStore;
+    Route routeStore;
+    bool restored = persistence.restore(fleetStore, routeStore);
+
+    // All menu changes go through the journaling wrappers (plain forwarding
+    // when no --journal was given).
+    JournaledFleet<Fleet> fleet(fleetStore, persistence.log());
+    JournaledRoute<Route> route(routeStore, persistence.log());
+
+    if (restored) {
+        std::cout << "\nSaved state restored. Fleet and route ready.\n";
+    } else {
+        loadSampleData(fleet, route);
+        std::cout << "\nSample data loaded. Fleet and route ready.\n";
+    }
 
     // ── Menu loop ─────────────────────────────────────────────────────────────
     int choice;
@@ -90,7 +403,7 @@ int main() {
             std::string cname   = readLine("Cargo name  : ");
             std::string ctype   = readLine("Cargo type  : ");
             int weight          = readInt ("Weight (tons): ");
-            fleet.loadCargo(trainId, Cargo<std::string>(cname, ctype, weight));
+            fleet.loadCargo(trainId, Cargo<Key>(cname, ctype, weight));
 
         } else if (choice == 5) {
             std::string trainId = readLine("Train ID    : ");
@@ -115,12 +428,16 @@ int main() {
         } else if (choice == 10) {
             route.advanceStation();
 
+        } else if (choice == 11) {
+            metrics::report(std::cout);
+
         } else if (choice != 0) {
             std::cout << "Invalid option.\n";
         }
 
     } while (choice != 0);
 
+    persistence.shutdown(fleetStore, routeStore);
     std::cout << "Goodbye!\n";
     return 0;
 }
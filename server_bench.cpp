@@ -0,0 +1,202 @@
+// server_bench — throughput and latency of FleetServer under pipelining clients
+//
+//   g++ -std=c++17 -O2 -pthread -DTRAIN_CARGO_NO_METRICS -o server_bench server_bench.cpp
+//   ./server_bench [clients] [requestsPerClient] [depth] [ioThreads]
+//
+// Starts a FleetServer in-process on a Unix socket, then every client thread
+// connects, adds its own train and keeps `depth` LOAD/UNLOAD requests in
+// flight (a LOAD followed by the UNLOAD of the same item), timing each one
+// from the write that sent it to the read that completed its reply. Prints
+// requests per second and latency percentiles over all clients, and fails if
+// any reply was not OK or the fleet is not empty again at the end.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "TrainFleet.h"
+#include "RouteLoop.h"
+#include "FleetServer.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct ClientResult {
+    std::vector<double> latencyUs;
+    long long failed = 0;
+    bool ok = true;
+};
+
+int connectTo(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof addr.sun_path, "%s", path.c_str());
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0) return fd;
+    if (fd >= 0) ::close(fd);
+    return -1;
+}
+
+// ── ReplyReader — splits "<status> <n>[ text]\n<n bytes>" replies ────────────
+class ReplyReader {
+private:
+    int fd;
+    std::string buf;
+    std::size_t pos = 0;
+
+public:
+    explicit ReplyReader(int fd) : fd(fd) {}
+
+    // Completed replies already buffered; reads more if there are none.
+    // Returns -1 on a closed or failed socket.
+    int next(std::vector<bool>& okFlags) {
+        for (;;) {
+            int n = 0;
+            for (;;) {
+                std::size_t nl = buf.find('\n', pos);
+                if (nl == std::string::npos) break;
+                std::size_t sp = buf.find(' ', pos);
+                std::size_t body = std::strtoul(buf.c_str() + sp + 1, nullptr, 10);
+                if (buf.size() < nl + 1 + body) break;
+                okFlags.push_back(buf.compare(pos, 3, "OK ") == 0);
+                pos = nl + 1 + body;
+                n++;
+            }
+            if (n > 0) {
+                buf.erase(0, pos);
+                pos = 0;
+                return n;
+            }
+            char tmp[65536];
+            ssize_t r = ::read(fd, tmp, sizeof tmp);
+            if (r <= 0) return -1;
+            buf.append(tmp, static_cast<std::size_t>(r));
+        }
+    }
+};
+
+// ── client — one pipelining connection ───────────────────────────────────────
+void client(const std::string& path, int id, int requests, int depth, ClientResult& out) {
+    int fd = connectTo(path);
+    if (fd < 0) {
+        out.ok = false;
+        return;
+    }
+    const std::string train = "B-" + std::to_string(id);
+    std::string setup = "ADD_TRAIN|" + train + "|Bench|1000000000\n";
+    ReplyReader reader(fd);
+    std::vector<bool> okFlags;
+    if (::write(fd, setup.data(), setup.size()) < 0 || reader.next(okFlags) != 1 || !okFlags[0]) {
+        out.ok = false;
+        ::close(fd);
+        return;
+    }
+
+    std::deque<Clock::time_point> sentAt;
+    std::string lines;
+    int sent = 0, done = 0;
+    out.latencyUs.reserve(static_cast<std::size_t>(requests));
+    while (done < requests) {
+        lines.clear();
+        for (; sent < requests && sent - done < depth; ++sent) {
+            const std::string item = "c" + std::to_string(sent / 2);
+            if (sent % 2 == 0) lines += "LOAD|" + train + "|" + item + "|Bulk|1\n";
+            else               lines += "UNLOAD|" + train + "|" + item + "\n";
+        }
+        if (!lines.empty()) {
+            const Clock::time_point now = Clock::now();
+            sentAt.insert(sentAt.end(), static_cast<std::size_t>(sent) - sentAt.size() - done, now);
+            if (::write(fd, lines.data(), lines.size()) != static_cast<ssize_t>(lines.size())) {
+                out.ok = false;
+                break;
+            }
+        }
+        okFlags.clear();
+        int n = reader.next(okFlags);
+        if (n < 0) {
+            out.ok = false;
+            break;
+        }
+        const Clock::time_point now = Clock::now();
+        for (int i = 0; i < n; ++i) {
+            out.latencyUs.push_back(std::chrono::duration<double, std::micro>(now - sentAt.front()).count());
+            sentAt.pop_front();
+            if (!okFlags[static_cast<std::size_t>(i)]) out.failed++;
+        }
+        done += n;
+    }
+    ::close(fd);
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    std::size_t i = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return sorted[i];
+}
+
+int main(int argc, char** argv) {
+    const int clients  = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int requests = argc > 2 ? std::atoi(argv[2]) : 100000;
+    const int depth    = argc > 3 ? std::atoi(argv[3]) : 64;
+    const unsigned io  = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 2;
+
+    TrainFleet<std::string> fleet;
+    RouteLoop<std::string> route;
+    fleet.setSink(nullptr);
+    route.setSink(nullptr);
+
+    ServerOptions options;
+    options.unixPath  = "/tmp/server_bench." + std::to_string(::getpid()) + ".sock";
+    options.ioThreads = io;
+    ServerStats st;
+    std::vector<ClientResult> results(static_cast<std::size_t>(clients));
+    double seconds = 0;
+    {
+        FleetServer<TrainFleet<std::string>, RouteLoop<std::string>> server(fleet, route, options);
+        std::string error;
+        if (!server.start(&error)) {
+            std::fprintf(stderr, "server: %s\n", error.c_str());
+            return 1;
+        }
+        const Clock::time_point start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int c = 0; c < clients; ++c)
+            threads.emplace_back(client, options.unixPath, c, requests, depth, std::ref(results[static_cast<std::size_t>(c)]));
+        for (std::thread& t : threads) t.join();
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        server.stop();
+        st = server.stats();
+    }
+
+    std::vector<double> all;
+    long long failed = 0;
+    bool ok = true;
+    for (const ClientResult& r : results) {
+        all.insert(all.end(), r.latencyUs.begin(), r.latencyUs.end());
+        failed += r.failed;
+        ok = ok && r.ok;
+    }
+    std::sort(all.begin(), all.end());
+    std::printf("%d clients x %d requests, depth %d, %u I/O threads\n", clients, requests, depth, io);
+    std::printf("  %zu replies in %.3f s: %.0f requests/s, %lld owner batches (%.1f lines each)\n",
+                all.size(), seconds, all.size() / (seconds > 0 ? seconds : 1), st.batches,
+                st.batches > 0 ? static_cast<double>(st.lines) / st.batches : 0.0);
+    std::printf("  latency us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+                percentile(all, 0.5), percentile(all, 0.9), percentile(all, 0.99),
+                percentile(all, 0.999), all.empty() ? 0.0 : all.back());
+
+    const bool empty = fleet.getTotalWeight() == 0;
+    if (!ok || failed != 0 || !empty) {
+        std::printf("FAILED: %s, %lld non-OK replies, %s\n", ok ? "all clients finished" : "a client broke off",
+                    failed, empty ? "fleet empty" : "cargo left behind");
+        return 1;
+    }
+    std::printf("  all replies OK, fleet empty again\n");
+    return 0;
+}